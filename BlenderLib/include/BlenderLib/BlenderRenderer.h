@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <memory>
+#include <functional>
 
 #ifdef WIN32
 #define EXPORT_THIS __declspec(dllexport)
@@ -10,6 +12,55 @@
 
 namespace Blender
 {
+	//---------------------------------------
+	// Handle of a submitted renderfile
+	//---------------------------------------
+	class RenderFuture
+	{
+		public:
+			//---------------------------------------
+			// Types
+			//---------------------------------------
+			// Shared with the renderer, defined by the implementation
+			struct State;
+
+		private:
+			//---------------------------------------
+			// Fields
+			//---------------------------------------
+			std::shared_ptr<State> futureState;
+
+		public:
+			//---------------------------------------
+			// Properties
+			//---------------------------------------
+			EXPORT_THIS bool IsValid() const;
+			EXPORT_THIS bool IsReady() const;
+			EXPORT_THIS bool IsCancelled() const;
+			// Timed out or crashed, outputs may be partially written
+			EXPORT_THIS bool HasFailed() const;
+			// Seconds the render process worked on it (0 if it didn't)
+			EXPORT_THIS float GetRenderTime() const;
+
+			//---------------------------------------
+			// Methods
+			//---------------------------------------
+			// Blocks until done, false if not rendered (delta rejected, failed or cancelled)
+			EXPORT_THIS bool Wait() const;
+			// True if done within the given seconds
+			EXPORT_THIS bool WaitFor(float seconds) const;
+			// Only possible before the render process picked it up
+			EXPORT_THIS bool Cancel();
+			// Called once done (immediately if already done)
+			EXPORT_THIS void OnComplete(const std::function<void(bool)>& callback);
+
+			//---------------------------------------
+			// Constructors
+			//---------------------------------------
+			EXPORT_THIS RenderFuture();
+			EXPORT_THIS RenderFuture(const std::shared_ptr<State>& state);
+	};
+
 	//---------------------------------------
 	// Blender Python API bridge
 	//---------------------------------------
@@ -27,13 +78,22 @@ namespace Blender
 			// Methods
 			//---------------------------------------
 			EXPORT_THIS void LogPerformance(const std::string& what, int thread);
-			EXPORT_THIS void ProcessRenderfile(const std::string& renderfile, float timeout, int thread);
+			EXPORT_THIS bool ProcessRenderfile(const std::string& renderfile, float timeout, int thread, bool isDelta = false);
+			EXPORT_THIS RenderFuture SubmitRenderfile(const std::string& renderfile, float timeout, int thread, bool isDelta = false);
+			// Converts textures into the shared cache (settings & textures, renderfile encoded)
+			EXPORT_THIS RenderFuture PrewarmTextures(const std::string& request, float timeout, int thread);
+			// Least loaded process, preferred one if it isn't busier by more than cost
+			EXPORT_THIS int SelectWorker(int preferred, float cost);
+			EXPORT_THIS int GetWorkerCount() const;
 			EXPORT_THIS void UnloadProcess(int thread);
+			// Clears the scene once everything submitted before is done
+			EXPORT_THIS RenderFuture ResetProcess(int thread);
+			EXPORT_THIS float PopStartupSaved();
 
 			//---------------------------------------
 			// Constructors
 			//---------------------------------------
-			EXPORT_THIS BlenderRenderer(int workerCount);
+			EXPORT_THIS BlenderRenderer(int workerCount, int memoryLimit = 0);
 			EXPORT_THIS ~BlenderRenderer();
 	};
 }
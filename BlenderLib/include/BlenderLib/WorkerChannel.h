@@ -0,0 +1,265 @@
+#pragma once
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <chrono>
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#pragma warning(push, 0)
+#include <boost/asio.hpp>
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+// Commands understood by the render processes
+#define CHANNEL_RENDER 1U
+#define CHANNEL_RESET 2U
+#define CHANNEL_CLOSE 3U
+#define CHANNEL_PREWARM 4U
+
+// Status, memory (MB), startup time (s)
+#define CHANNEL_REPLY_SIZE 20
+
+namespace Blender
+{
+	typedef boost::asio::ip::tcp::socket ChannelSocket;
+
+	//---------------------------------------
+	// Waits until a socket / acceptor can be read
+	//---------------------------------------
+	template<typename Handle>
+	static bool WaitReadable(
+		Handle handle,
+		float timeout
+	)
+	{
+#ifdef _WIN32
+		WSAPOLLFD pollHandle = {};
+#else
+		pollfd pollHandle = {};
+#endif
+		pollHandle.fd = handle;
+		pollHandle.events = POLLIN;
+
+		// Interrupted waits continue with the remaining time
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<float>(timeout < 0.0f ? 0.0f : timeout));
+		while (true)
+		{
+			// Negative timeout waits forever
+			int waitMs = -1;
+			if (timeout >= 0.0f)
+			{
+				auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+				waitMs = static_cast<int>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0));
+			}
+#ifdef _WIN32
+			int result = WSAPoll(&pollHandle, 1, waitMs);
+#else
+			int result = poll(&pollHandle, 1, waitMs);
+			if (result < 0 && errno == EINTR)
+				continue;
+#endif
+			// Errors & hangups are readable too, the following read reports them
+			return result > 0;
+		}
+	}
+
+	//---------------------------------------
+	// Accepts connections of render processes
+	//---------------------------------------
+	class ChannelListener
+	{
+	private:
+		//---------------------------------------
+		// Fields
+		//---------------------------------------
+
+		boost::asio::io_context ioContext;
+		boost::asio::ip::tcp::acceptor acceptor;
+		std::map<int, std::unique_ptr<ChannelSocket>> pendingSockets;
+		std::mutex acceptLock;
+
+	public:
+		//---------------------------------------
+		// Properties
+		//---------------------------------------
+
+		inline int GetPort() const { return acceptor.local_endpoint().port(); }
+
+		//---------------------------------------
+		// Methods
+		//---------------------------------------
+
+		// Returns connection of the process, NULL on timeout
+		std::unique_ptr<ChannelSocket> Accept(
+			int index,
+			float timeout
+		)
+		{
+			std::lock_guard<std::mutex> lock(acceptLock);
+			while (pendingSockets.count(index) == 0)
+			{
+				// Wait for the next process to connect
+				if (!WaitReadable(acceptor.native_handle(), timeout))
+					return NULL;
+
+				boost::system::error_code error;
+				std::unique_ptr<ChannelSocket> accepted(new ChannelSocket(ioContext));
+				acceptor.accept(*accepted, error);
+				if (error)
+					continue;
+
+				// Process identifies itself first
+				uint32_t connected = 0;
+				boost::asio::read(*accepted, boost::asio::buffer(&connected, sizeof(uint32_t)), error);
+				if (error)
+					continue;
+				accepted->set_option(boost::asio::ip::tcp::no_delay(true), error);
+				pendingSockets[static_cast<int>(connected)] = std::move(accepted);
+			}
+
+			std::unique_ptr<ChannelSocket> found = std::move(pendingSockets[index]);
+			pendingSockets.erase(index);
+			return found;
+		}
+
+		// Removes connections of a process that is restarted
+		void Forget(
+			int index
+		)
+		{
+			std::lock_guard<std::mutex> lock(acceptLock);
+			pendingSockets.erase(index);
+		}
+
+		//---------------------------------------
+		// Constructors
+		//---------------------------------------
+
+		ChannelListener() :
+			ioContext(),
+			acceptor(ioContext, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+		{
+		}
+
+		// No copy / move allowed
+		ChannelListener(const ChannelListener& copy) = delete;
+		ChannelListener(ChannelListener&& other) = delete;
+	};
+
+	//---------------------------------------
+	// Native connection to one render process
+	//---------------------------------------
+	class WorkerChannel
+	{
+	public:
+		//---------------------------------------
+		// Types
+		//---------------------------------------
+
+		struct Reply
+		{
+			bool Valid;
+			bool Success;
+			double MemoryMB;
+			double StartupTime;
+		};
+
+	private:
+		//---------------------------------------
+		// Fields
+		//---------------------------------------
+
+		std::unique_ptr<ChannelSocket> socket;
+
+	public:
+		//---------------------------------------
+		// Properties
+		//---------------------------------------
+
+		inline bool IsConnected() const { return socket != NULL; }
+
+		//---------------------------------------
+		// Methods
+		//---------------------------------------
+
+		inline void Connect(std::unique_ptr<ChannelSocket>&& connected) { socket = std::move(connected); }
+
+		inline void Disconnect()
+		{
+			if (socket)
+			{
+				boost::system::error_code error;
+				socket->close(error);
+				socket.reset();
+			}
+		}
+
+		// Sends command & waits for the reply, invalid on timeout / crash
+		Reply Request(
+			uint32_t command,
+			const std::string& payload,
+			float timeout
+		)
+		{
+			Reply reply{ false, false, 0.0, 0.0 };
+			if (!socket)
+				return reply;
+
+			// Header: command & payload size
+			char header[12];
+			uint64_t size = payload.size();
+			memcpy(header, &command, sizeof(uint32_t));
+			memcpy(header + 4, &size, sizeof(uint64_t));
+
+			boost::system::error_code error;
+			std::array<boost::asio::const_buffer, 2> request = {
+				boost::asio::buffer(header, sizeof(header)),
+				boost::asio::buffer(payload)
+			};
+			boost::asio::write(*socket, request, error);
+			if (error)
+				return reply;
+
+			// Process does not answer in time
+			if (!WaitReadable(socket->native_handle(), timeout))
+				return reply;
+
+			char answer[CHANNEL_REPLY_SIZE];
+			boost::asio::read(*socket, boost::asio::buffer(answer, CHANNEL_REPLY_SIZE), error);
+			if (error)
+				return reply;
+
+			uint32_t status;
+			memcpy(&status, answer, sizeof(uint32_t));
+			memcpy(&reply.MemoryMB, answer + 4, sizeof(double));
+			memcpy(&reply.StartupTime, answer + 12, sizeof(double));
+			reply.Success = status == 0;
+			reply.Valid = true;
+			return reply;
+		}
+
+		//---------------------------------------
+		// Constructors
+		//---------------------------------------
+
+		WorkerChannel() :
+			socket()
+		{
+		}
+
+		~WorkerChannel()
+		{
+			Disconnect();
+		}
+	};
+}
@@ -82,6 +82,8 @@ class CameraInstance(ObjectWrapper):
         self.__rayBounces = -1
         self.__shadingOverride = ""
         self.__exposure = 0.0
+        self.__crop = None
+        self.__denoise = True
 
     # Get camera data
     @property
@@ -158,6 +160,26 @@ class CameraInstance(ObjectWrapper):
     def CameraExposure(self, value):
         self.__exposure = value
 
+    # Get crop window [x, y, width, height] in pixels (None: whole image)
+    @property
+    def CameraCrop(self):
+        return self.__crop
+
+    # Set crop window [x, y, width, height] in pixels (None: whole image)
+    @CameraCrop.setter
+    def CameraCrop(self, value):
+        self.__crop = value
+
+    # Get if appleseed's denoiser is used
+    @property
+    def CameraDenoise(self):
+        return self.__denoise
+
+    # Set if appleseed's denoiser is used
+    @CameraDenoise.setter
+    def CameraDenoise(self, value):
+        self.__denoise = value
+
     # Override: Create from json data
     def CreateFromJSON(self, data : dict):
         assert data is not None
@@ -169,3 +191,5 @@ class CameraInstance(ObjectWrapper):
         self.CameraRayBounces = data.get("rayBounces", -1)
         self.CameraShadingOverride = data.get("shadingOverride", "")
         self.CameraExposure = data.get("exposure", 0.0)
+        self.CameraCrop = data.get("crop", None)
+        self.CameraDenoise = data.get("denoise", True)
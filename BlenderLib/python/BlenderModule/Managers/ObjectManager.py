@@ -1,10 +1,11 @@
 from ..Converters import Base, Camera, Lights, Material, Mesh, Shader
 from ..Utils.Logger import GetLogger
-from ..Utils import FileName
+from ..Utils import FileName, FullPath
 
 logger = GetLogger()
 
 from typing import List, Dict, Generic, TypeVar
+from zlib import crc32
 
 T = TypeVar("T",
             Camera.CameraData,
@@ -126,6 +127,20 @@ class InstanceStorage(Generic[V, T], BlueprintStorage[T]):
         # Clear up to date cache
         self.__updateCache.clear()
 
+    # Removes all instances, blueprints are kept
+    def RemoveAllInstances(self):
+        self.__updateCache.clear()
+        self.RemoveStaleInstances()
+
+    # Removes instances by hash, all others are kept
+    def RemoveInstances(self, hashes):
+        for hashed in hashes:
+            if hashed in self.__hashCache:
+                logger.info(f"Removing {self.__hashCache[hashed]}")
+                self._RemoveInstance(self.__hashCache[hashed])
+        # Clear up to date cache
+        self.__updateCache.clear()
+
     # Forwarded: Make new instance from json data & blueprint
     def _MakeInstance(self, data : dict, blueprint : T) -> V:
         raise NotImplementedError
@@ -199,7 +214,9 @@ class MeshFactory(InstanceStorage[Mesh.MeshInstance, Mesh.MeshData]):
     # Override: Get blueprint identifier
     def _GetBlueprintID(self, data : dict):
         assert data is not None
-        return f'mesh_{FileName(data.get("file", "?"))}'
+        # Different scenes use the same mesh file names
+        meshFile = data.get("file", "?")
+        return f'mesh_{FileName(meshFile)}_{crc32(FullPath(meshFile).encode("utf-8")):08x}'
 
     # Override: Make new blueprint from json data
     def _MakeBlueprint(self, data : dict) -> Mesh.MeshData:
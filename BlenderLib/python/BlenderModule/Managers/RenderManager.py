@@ -5,10 +5,31 @@ from ..Utils import FullPath, FileDir
 from typing import List
 from os import chdir
 from sys import exc_info
-from time import sleep
+from time import sleep, time
 
 import multiprocessing as mp
-import json
+import os
+
+# Special queue entry, clears the scene in place
+RESET_SCENE = b"reset"
+RESET_TIMEOUT = 30.0
+# Failed renders repeated before giving up (same as C++)
+RENDER_RETRIES = 2
+# Failed process creations repeated before giving up
+CREATE_RETRIES = 20
+
+# Resident memory of a process in MB (0 if unknown)
+def ProcessMemory(pid):
+    try:
+        import psutil
+        return psutil.Process(pid).memory_info().rss / (1 << 20)
+    except ImportError:
+        pass
+    try:
+        with open(f"/proc/{pid}/statm", "r") as statm:
+            return int(statm.read().split()[1]) * os.sysconf("SC_PAGE_SIZE") / (1 << 20)
+    except (OSError, ValueError):
+        return 0
 
 # Queue supporting joining with timeout
 class TimeoutQueue(JoinableQueue):
@@ -18,38 +39,70 @@ class TimeoutQueue(JoinableQueue):
         with self._cond:
             if not self._unfinished_tasks._semlock._is_zero():
                 return self._cond.wait(timeout)
+            return True
 
 # Single render process
 class RenderProcess(mp.Process):
 
-    def __init__(self, fileQueue, closeEvent, importPaths):
+    def __init__(self, fileQueue, closeEvent, startupTime, renderFailed, importPaths, channelPort=0, index=0):
         super().__init__(target=self.RenderLoop, args=importPaths)
         self.__fileQueue : TimeoutQueue
         self.__fileQueue = fileQueue
         self.__closeEvent : mp.Event
         self.__closeEvent = closeEvent
+        self.__startupTime : mp.Value
+        self.__startupTime = startupTime
+        self.__renderFailed : mp.Value
+        self.__renderFailed = renderFailed
+        self.__created = time()
         self.__scene = None
+        self.__channelPort = channelPort
+        self.__index = index
 
     def RenderLoop(self, *paths):
         # Setup for multiprocessing
         SetPaths(paths[0], paths[1])
         # Scene imports
-        from .SceneManager import CreateFromJSON, UpdateFromJSON
+        from .SceneManager import CreateFromJSON, UpdateFromJSON, PrewarmFromJSON
+        from ..Utils.RenderfileCodec import Decode
         # Change working dir in process
         chdir(FullPath(f"{FileDir(__file__)}/../"))
+        # Commands come directly from C++ if available
+        if self.__channelPort > 0:
+            return self.__ChannelLoop(CreateFromJSON, UpdateFromJSON, PrewarmFromJSON, Decode)
         # Process file queue
         while True:
             try:
-                # Check for work
+                # Check for work (encoded renderfile)
                 data = self.__fileQueue.get(True, 0.1)
-                # Create or update scene
-                if self.__scene is None:
-                    self.__scene = CreateFromJSON(data)
-                else:
-                    self.__scene = UpdateFromJSON(data, self.__scene)
-                # Process render queue
-                while self.__scene.RenderQueueRemaining() > 0:
-                    self.__scene.RenderQueueProcessNext()
+                # Clear scene but keep blender & plugin loaded
+                if data == RESET_SCENE:
+                    if self.__scene is not None:
+                        self.__scene.Reset()
+                    self.__fileQueue.task_done()
+                    continue
+                self.__renderFailed.value = False
+                try:
+                    data = Decode(data)
+                    # Delta needs the scene it is based on
+                    if self.__scene is None and data.get("delta", False):
+                        self.__renderFailed.value = True
+                    else:
+                        # Create or update scene
+                        if self.__scene is None:
+                            self.__scene = CreateFromJSON(data)
+                            # Process spawn & blender setup duration (without the first scene)
+                            self.__startupTime.value = self.__scene.ReadyTime - self.__created
+                        else:
+                            self.__scene = UpdateFromJSON(data, self.__scene)
+                        # Process render queue
+                        while self.__scene.RenderQueueRemaining() > 0:
+                            self.__scene.RenderQueueProcessNext()
+                except Exception as ex:
+                    # Scene is in an unknown state now
+                    exInfo = exc_info()
+                    print(f"Unexpected exception {exInfo[0]}: {exInfo[1]} ({ex})")
+                    self.__renderFailed.value = True
                 # Signal rendering complete to main thread
                 self.__fileQueue.task_done()
             except mp.queues.Empty:
@@ -57,6 +110,48 @@ class RenderProcess(mp.Process):
                 if self.__closeEvent.wait(0.1):
                     break
 
+    # Serves the native channel until it is closed
+    def __ChannelLoop(self, create, update, prewarm, decode):
+        from ..Utils.WorkerChannel import WorkerChannel, CHANNEL_RENDER, CHANNEL_RESET, CHANNEL_CLOSE, CHANNEL_PREWARM
+        channel = WorkerChannel(self.__channelPort, self.__index)
+        while True:
+            command, payload = channel.Receive()
+            if command == CHANNEL_CLOSE:
+                break
+            success = True
+            try:
+                # Clear scene but keep blender & plugin loaded
+                if command == CHANNEL_RESET:
+                    if self.__scene is not None:
+                        self.__scene.Reset()
+                # Fill texture cache, scene is not touched
+                elif command == CHANNEL_PREWARM:
+                    prewarm(decode(payload))
+                elif command == CHANNEL_RENDER:
+                    data = decode(payload)
+                    # Delta needs the scene it is based on, C++ resends in full
+                    if self.__scene is None and data.get("delta", False):
+                        success = False
+                    else:
+                        # Create or update scene
+                        if self.__scene is None:
+                            self.__scene = create(data)
+                            # Process spawn & blender setup duration (without the first scene)
+                            self.__startupTime.value = self.__scene.ReadyTime - self.__created
+                        else:
+                            self.__scene = update(data, self.__scene)
+                        # Process render queue
+                        while self.__scene.RenderQueueRemaining() > 0:
+                            self.__scene.RenderQueueProcessNext()
+            except Exception as ex:
+                # Scene is in an unknown state now
+                exInfo = exc_info()
+                print(f"Unexpected exception {exInfo[0]}: {exInfo[1]} ({ex})")
+                success = False
+            # Memory is reported so C++ can recycle large processes
+            channel.Reply(success, ProcessMemory(os.getpid()), self.__startupTime.value)
+        channel.Close()
+
 # Render manager, handles multithreaded rendering
 class RenderManager(object):
 
@@ -72,10 +167,14 @@ class RenderManager(object):
     class UnloadException(Exception):
         pass
 
-    def __init__(self, workerThreads):
+    def __init__(self, workerThreads, memoryLimit=0, channelPort=0):
         self.__maxWorkers = workerThreads
-        self.__workers : List[(RenderProcess, TimeoutQueue, mp.Event)]
+        self.__memoryLimit = memoryLimit
+        self.__channelPort = channelPort
+        self.__workers : List[(RenderProcess, TimeoutQueue, mp.Event, mp.Value, mp.Value)]
         self.__workers = [None for i in range(self.__maxWorkers)]
+        self.__startupTimes = [0.0 for i in range(self.__maxWorkers)]
+        self.__startupSaved = 0.0
         for i in range(self.__maxWorkers):
             self.__CreateProcess(i)
 
@@ -83,29 +182,63 @@ class RenderManager(object):
         for pc in mp.active_children():
             pc.terminate()
 
-    # Process renderfile multithreaded
-    def ProcessRenderfile(self, renderfile, timeout, thread):
+    # Process renderfile multithreaded, false if it failed or a delta renderfile could not be applied
+    def ProcessRenderfile(self, renderfile, timeout, thread, isDelta=False):
         assert thread < self.__maxWorkers
-        # Parse string to json
-        scene = json.loads(renderfile)
         # Prevent exceptions (crashes C++!)
         try:
-            # Make sure process is spawned
-            self.__EnsureRunning(thread)
-            # Fetch worker queue
-            _,queue,_ = self.__workers[thread]
-            # Enqueue renderfile and block until completed
-            queue.put(scene, True)
-            # Make sure rendering doesn't get stuck
-            if not queue.join_with_timeout(timeout):
+            for attempt in range(RENDER_RETRIES + 1):
+                # Make sure process is spawned
+                self.__EnsureRunning(thread)
+                # Fetch worker queue
+                _,queue,_,_,renderFailed = self.__workers[thread]
+                # Enqueue encoded renderfile (decoded by worker) and block until completed
+                queue.put(renderfile, True)
+                # Worker reports exceptions & rejected deltas
+                if queue.join_with_timeout(timeout):
+                    return not renderFailed.value
                 # If rendering is stuck, reload process
                 self.UnloadProcess(thread)
-                # Try again
-                self.ProcessRenderfile(renderfile, timeout, thread)
+                # New process has no scene to apply the delta to
+                if isDelta:
+                    return False
+            print(f"Giving up on renderfile after {RENDER_RETRIES} retries")
         except Exception as ex:
             # Debug output on crash
             exInfo = exc_info()
             print(f"Unexpected exception {exInfo[0]}: {exInfo[1]} ({ex})")
+        return False
+
+    # Clear scene of process, only reload if it uses too much memory
+    def ResetProcess(self, thread):
+        assert thread < self.__maxWorkers
+        try:
+            # Nothing to reset if not running
+            if self.__workers[thread] is None or not self.__workers[thread][0].is_alive():
+                return self.UnloadProcess(thread)
+            renderPrc,queue,_,startupTime,_ = self.__workers[thread]
+            # Recycle process if it grew too large
+            if self.__memoryLimit > 0 and ProcessMemory(renderPrc.pid) > self.__memoryLimit:
+                return self.UnloadProcess(thread)
+            # Otherwise clear the scene in place
+            queue.put(RESET_SCENE, True)
+            if not queue.join_with_timeout(RESET_TIMEOUT):
+                return self.UnloadProcess(thread)
+            # Spawning & setup were avoided
+            self.__startupSaved += max(startupTime.value, self.__startupTimes[thread])
+            self.__startupTimes[thread] = max(startupTime.value, self.__startupTimes[thread])
+            return True
+        except Exception as ex:
+            # Debug output on crash
+            exInfo = exc_info()
+            print(f"Unexpected exception {exInfo[0]}: {exInfo[1]} ({ex})")
+            return False
+
+    # Returns seconds of process startup saved by resets (since last call)
+    def PopStartupSaved(self):
+        saved = self.__startupSaved
+        self.__startupSaved = 0.0
+        return saved
 
     # Remove and reload all process
     def UnloadProcess(self, thread):
@@ -131,9 +264,11 @@ class RenderManager(object):
                 # Create synchronization objects
                 fileQueue = TimeoutQueue(maxsize=1, ctx=mp.get_context())
                 closeEvent = mp.Event()
+                startupTime = mp.Value("d", 0.0)
+                renderFailed = mp.Value("b", False)
                 # Create, start & save render process
-                renderPrc = RenderProcess(fileQueue, closeEvent, GetPaths())
-                self.__workers.insert(index, (renderPrc, fileQueue, closeEvent))
+                renderPrc = RenderProcess(fileQueue, closeEvent, startupTime, renderFailed, GetPaths(), self.__channelPort, index)
+                self.__workers[index] = (renderPrc, fileQueue, closeEvent, startupTime, renderFailed)
                 renderPrc.daemon = True
                 renderPrc.start()
                 return True
@@ -146,7 +281,7 @@ class RenderManager(object):
         if index < self.__maxWorkers:
             if self.__workers[index] is not None:
                 # Get process and close signal
-                renderPrc,queue,closeEvent = self.__workers[index]
+                renderPrc,queue,closeEvent,_,_ = self.__workers[index]
                 # Set signal, see if it terminates
                 closeEvent.set()
                 renderPrc.join(0.5)
@@ -171,9 +306,16 @@ class RenderManager(object):
     # Makes sure the process is running
     def __EnsureRunning(self, thread):
         assert thread < self.__maxWorkers
-        # Retry process creation until it works
-        while self.__workers[thread] is None:
+        # Replace crashed process
+        if self.__workers[thread] is not None and not self.__workers[thread][0].is_alive():
+            self.__RemoveProcess(thread)
+        # Retry process creation a limited number of times
+        for attempt in range(CREATE_RETRIES + 1):
+            if self.__workers[thread] is not None:
+                return
             try:
                 self.__CreateProcess(thread)
             except RenderManager.CreateException:
                 sleep(0.5)
+        if self.__workers[thread] is None:
+            raise RenderManager.CreateException
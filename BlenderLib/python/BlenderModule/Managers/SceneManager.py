@@ -1,5 +1,6 @@
 from ..Utils.Importer import ImportBpy
 from ..Utils.ShaderCompiler import CompileFolder, EnsureInstalled
+from ..Utils.TextureConverter import ConvertTexture
 from ..Utils.Logger import GetLogger, GetLevel, SetLevel
 from ..Utils.OutputMuter import BlenderMute, StdMute
 from ..Utils import FileDir, FileName, FullFileName, FullPath
@@ -11,6 +12,7 @@ bpy = ImportBpy()
 logger = GetLogger()
 
 from typing import List
+from time import time
 import sys
 import os
 
@@ -24,14 +26,28 @@ class Scene(object):
         self.__lights = ObjectManager.LightFactory()
         self.__renderQueue : List[Camera.CameraInstance]
         self.__renderQueue = []
+        # Last complete entries per ID, delta renderfiles only contain changed members
+        self.__sentEntries = {"cameras": {}, "meshes": {}, "lights": {}}
         # Setup blenderseed
         self.__SetGeneralSettings(settings)
+        # Blender & plugin are ready, objects are not part of the startup
+        self.__readyTime = time()
 
     def __del__(self):
         del self.__cameras
         del self.__meshes
         del self.__lights
         del self.__renderQueue
+        del self.__sentEntries
+
+    # Remove all objects, loaded meshes, textures & plugins are kept
+    def Reset(self):
+        self.RenderQueueClear()
+        self.__cameras.RemoveAllInstances()
+        self.__meshes.RemoveAllInstances()
+        self.__lights.RemoveAllInstances()
+        for entries in self.__sentEntries.values():
+            entries.clear()
 
     # Enque camera for rendering
     def RenderQueueAdd(self, camera : Camera.CameraInstance):
@@ -86,6 +102,16 @@ class Scene(object):
         ctx.render.image_settings.color_depth = ("8", "32")[camera.CameraDataOnly]
         ctx.render.resolution_x = camera.CameraResolution[0]
         ctx.render.resolution_y = camera.CameraResolution[1]
+        # Only render crop window, image keeps full resolution
+        ctx.render.use_border = camera.CameraCrop is not None
+        ctx.render.use_crop_to_border = False
+        if ctx.render.use_border:
+            x, y, width, height = camera.CameraCrop
+            ctx.render.border_min_x = x / camera.CameraResolution[0]
+            ctx.render.border_max_x = (x + width) / camera.CameraResolution[0]
+            # Blender's y axis points up
+            ctx.render.border_min_y = 1.0 - (y + height) / camera.CameraResolution[1]
+            ctx.render.border_max_y = 1.0 - y / camera.CameraResolution[1]
         # Shading override
         ctx.appleseed.shading_override = len(camera.CameraShadingOverride) > 0
         if ctx.appleseed.shading_override:
@@ -107,7 +133,7 @@ class Scene(object):
             ctx.appleseed.samples = 1
         else:
             ctx.appleseed.pixel_sampler = "adaptive"
-            ctx.appleseed.denoise_mode = "on"
+            ctx.appleseed.denoise_mode = ("off", "on")[camera.CameraDenoise]
             ctx.appleseed.adaptive_min_samples = max(camera.CameraAASamples, 1)
             ctx.appleseed.adaptive_max_samples = min(max(pow(camera.CameraAASamples, 2), 1), 256)
             ctx.appleseed.adaptive_batch_size = max(camera.CameraAASamples / 2, 1)
@@ -133,15 +159,18 @@ class Scene(object):
         searchPaths = ""
         compilePaths = settings.get("shaderDirs", [])
         compilePaths.append(FullPath(f"{FileDir(__file__)}/../Shaders/"))
+        # Compiled shaders are cached between processes & runs
+        cacheFolder = settings.get("cachePath", None)
+        cacheFolder = FullPath(cacheFolder) if cacheFolder else None
         # Compile & add each shader directory (always in debug mode)
         forceCompile = logger.level < 30 and self.__storeBlend
         for shaderPath in [FullPath(path) for path in compilePaths]:
-            CompileFolder(shaderPath, modulePath, forceCompile)
+            CompileFolder(shaderPath, modulePath, forceCompile, cacheFolder)
             searchPaths += os.path.pathsep + shaderPath
         # Set shader searchpaths
         os.environ["APPLESEED_SEARCHPATH"] = searchPaths
         # Init texture system
-        Shader.SetTextureSystem(TextureManager.TextureFactory(modulePath))
+        Shader.SetTextureSystem(TextureManager.TextureFactory(modulePath, cacheFolder))
         # Init blenderseed plugin
         with StdMute():
             if isInstalled:
@@ -160,6 +189,11 @@ class Scene(object):
         # Limit cache to 1GB
         bpy.context.preferences.system.memory_cache_limit = 1024
 
+    # Get time when blender & plugin were set up
+    @property
+    def ReadyTime(self):
+        return self.__readyTime
+
     # Get camera manager
     @property
     def CameraManager(self):
@@ -175,25 +209,64 @@ class Scene(object):
     def MeshManager(self):
         return self.__meshes
 
+    # Completes entries with the members they had in earlier renderfiles
+    def MergeEntries(self, kind : str, entries : list, idKey : str, delta : bool, complete : bool) -> list:
+        sent = self.__sentEntries[kind]
+        if not delta:
+            sent.clear()
+        merged = []
+        for entry in entries:
+            entryID = entry.get(idKey, None)
+            # Untracked renderfiles have no IDs
+            if entryID is None:
+                merged.append(entry)
+                continue
+            # Members that are no longer sent are dropped if replaced
+            if delta and entryID in sent and not entry.pop("replace", False):
+                full = dict(sent[entryID])
+                full.update(entry)
+            else:
+                full = entry
+            sent[entryID] = full
+            merged.append(full)
+        # Complete lists (cameras & lights) contain every entry the sender tracks
+        if complete:
+            listed = set(entry.get(idKey, None) for entry in entries)
+            for entryID in [entryID for entryID in sent if entryID not in listed]:
+                del sent[entryID]
+        return merged
+
+    # Forgets entries that were removed
+    def RemoveEntries(self, kind : str, removed : list):
+        for entryID in removed:
+            self.__sentEntries[kind].pop(entryID, None)
+
+    # Delta renderfile only lists the IDs if no entry changed
+    def EntriesChanged(self, kind : str, entries : list, idKey : str) -> bool:
+        sent = self.__sentEntries[kind]
+        return len(entries) != len(sent) or any(len(entry) > 1 or entry.get(idKey, None) not in sent for entry in entries)
+
 # Build and return scene from json
 def CreateFromJSON(data : dict) -> Scene:
     # Create scene & initialize blender
     build : Scene = Scene(data.get("settings", {}))
 
     # Build cameras & enque for rendering
-    for camData in data.get("cameras", []):
+    for camData in build.MergeEntries("cameras", data.get("cameras", []), "cameraID", False, True):
         cam = build.RenderQueueAdd(build.CameraManager.GetInstance(camData))
         logger.info(f"{build}: Added {cam.Name}")
     build.CameraManager.RemoveStaleInstances()
 
     # Build meshes
-    for meshData in data.get("meshes", []):
+    if data.get("delta", False):
+        logger.error(f"{build}: Delta renderfile without previous scene")
+    for meshData in build.MergeEntries("meshes", data.get("meshes", []), "objectID", False, False):
         mesh = build.MeshManager.GetInstance(meshData)
         logger.info(f"{build}: Added {mesh.Name}")
     build.MeshManager.RemoveStaleInstances()
 
     # Build lights
-    for lightData in data.get("lights", []):
+    for lightData in build.MergeEntries("lights", data.get("lights", []), "lightID", False, True):
         light = build.LightManager.GetInstance(lightData)
         logger.info(f"{build}: Added {light.Name}")
     build.LightManager.RemoveStaleInstances()
@@ -206,27 +279,51 @@ def UpdateFromJSON(data : dict, scene : Scene) -> Scene:
     # Remove remaining queue
     scene.RenderQueueClear()
 
+    # Delta: Only changed members are sent, the rest is kept from earlier renderfiles
+    delta = data.get("delta", False)
+
     # Remove & rebuild cameras
-    for camData in data.get("cameras", []):
+    for camData in scene.MergeEntries("cameras", data.get("cameras", []), "cameraID", delta, True):
         cam = scene.RenderQueueAdd(scene.CameraManager.GetInstance(camData))
         logger.info(f"{scene}: Added {cam.Name}")
     scene.CameraManager.RemoveStaleInstances()
 
-    # Update / create meshes
-    for meshData in data.get("meshes", []):
+    # Update / create meshes (delta: only changed ones)
+    for meshData in scene.MergeEntries("meshes", data.get("meshes", []), "objectID", delta, False):
         mesh = scene.MeshManager.UpdateInstance(meshData)
         if mesh is not None:
             logger.info(f"{scene}: Updated {mesh.Name}")
         else:
             mesh = scene.MeshManager.GetInstance(meshData)
             logger.info(f"{scene}: Added {mesh.Name}")
-    scene.MeshManager.RemoveStaleInstances()
+    # Delta: Unchanged meshes are kept, removed ones are listed
+    if delta:
+        scene.MeshManager.RemoveInstances(data.get("removed", []))
+        scene.RemoveEntries("meshes", data.get("removed", []))
+    else:
+        scene.MeshManager.RemoveStaleInstances()
 
-    # Remove & rebuild lights
-    for lightData in data.get("lights", []):
-        light = scene.LightManager.GetInstance(lightData)
-        logger.info(f"{scene}: Added {light.Name}")
-    scene.LightManager.RemoveStaleInstances()
+    # Remove & rebuild lights (delta: only if any changed)
+    lightsData = data.get("lights", [])
+    if not delta or scene.EntriesChanged("lights", lightsData, "lightID"):
+        for lightData in scene.MergeEntries("lights", lightsData, "lightID", delta, True):
+            light = scene.LightManager.GetInstance(lightData)
+            logger.info(f"{scene}: Added {light.Name}")
+        scene.LightManager.RemoveStaleInstances()
 
     # Return updated scene
     return scene
+
+# Convert textures into the shared cache ahead of rendering
+def PrewarmFromJSON(data : dict):
+    settings = data.get("settings", {})
+    cacheFolder = settings.get("cachePath", None)
+    # Only useful if other processes can use the result
+    if not cacheFolder:
+        return
+    modulePath = f'{bpy.utils.user_resource("SCRIPTS", "addons")}/blenderseed'
+    EnsureInstalled(modulePath, FullPath(settings.get("pluginPath", "../blenderseed.zip")))
+    for tex in data.get("textures", []):
+        imagePath = tex.get("filePath", "")
+        if len(imagePath) > 0 and os.path.exists(imagePath):
+            ConvertTexture(imagePath, tex.get("colorSpace"), tex.get("colorDepth"), modulePath, FullPath(cacheFolder))
@@ -9,8 +9,9 @@ logger = GetLogger()
 
 class TextureFactory(object):
 
-    def __init__(self, modulePath):
+    def __init__(self, modulePath, cacheFolder=None):
         self.__modulePath = modulePath
+        self.__cacheFolder = cacheFolder
         self.__mapping = {}
 
     # Add image & convert accordingly to texture
@@ -18,7 +19,7 @@ class TextureFactory(object):
         # Only add if image exists & has not been added
         if len(imagePath) > 0:
             if not imagePath in self.__mapping:
-                self.__mapping[imagePath] = ConvertTexture(imagePath, colorSpace, colorDepth, self.__modulePath)
+                self.__mapping[imagePath] = ConvertTexture(imagePath, colorSpace, colorDepth, self.__modulePath, self.__cacheFolder)
 
     # Get path of converted texture
     def GetTexture(self, imagePath):
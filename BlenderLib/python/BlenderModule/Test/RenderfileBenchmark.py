@@ -0,0 +1,54 @@
+from ..Utils.RenderfileCodec import Decode, Encode
+
+import multiprocessing as mp
+import json
+import time
+
+# Stand-in render process, only decodes
+def DecodeLoop(queue, decode):
+    while True:
+        data = queue.get()
+        if data is None:
+            queue.task_done()
+            break
+        if decode:
+            Decode(data)
+        queue.task_done()
+
+# Measures main process & transfer time for one renderfile format
+def BenchmarkFormat(name, renderfile, count, parseInMain):
+    queue = mp.JoinableQueue(maxsize=1)
+    worker = mp.Process(target=DecodeLoop, args=(queue, not parseInMain))
+    worker.start()
+    mainTime = 0.0
+    totalTime = 0.0
+    for _ in range(count):
+        start = time.perf_counter()
+        # Legacy path parses in the main process and pickles the dict
+        data = json.loads(renderfile) if parseInMain else renderfile
+        queue.put(data, True)
+        mainTime += time.perf_counter() - start
+        queue.join()
+        totalTime += time.perf_counter() - start
+    queue.put(None)
+    queue.join()
+    worker.join()
+    print(f"{name:<16} {len(renderfile):>10} bytes  main {1000.0 * mainTime / count:8.3f} ms  total {1000.0 * totalTime / count:8.3f} ms")
+
+# Compares renderfile formats, main time blocks the C++ threads (GIL)
+def BenchmarkRenderfiles(path="./BlenderModule/Test/module_test_base.json", count=200, scale=50):
+    testScene = json.load(open(path))
+    # Enlarge scene to a realistic object count
+    testScene["meshes"] = testScene["meshes"] * scale
+    jsonFile = Encode(testScene, False)
+    binaryFile = Encode(testScene, True)
+    # Serialization (Python encoder, the C++ writers are timed by RenderfileBenchmark.cpp)
+    for name, binary in [("json", False), ("binary", True)]:
+        start = time.perf_counter()
+        for _ in range(count):
+            Encode(testScene, binary)
+        print(f"Encode {name:<9} {1000.0 * (time.perf_counter() - start) / count:8.3f} ms")
+    # Transfer & decoding
+    BenchmarkFormat("json (legacy)", jsonFile, count, True)
+    BenchmarkFormat("json", jsonFile, count, False)
+    BenchmarkFormat("binary", binaryFile, count, False)
@@ -0,0 +1,42 @@
+from hashlib import sha1
+from time import sleep, time
+
+import os
+
+# Seconds to wait for another process creating the same file
+LOCK_TIMEOUT = 60.0
+
+# Cache key from arbitrary values
+def CacheKey(*values):
+    return sha1("|".join(str(value) for value in values).encode("utf-8")).hexdigest()
+
+# Returns cached file, created once by create(tempFile) if missing
+def CachedFile(cacheFile, create, forceCreate=False):
+    if os.path.exists(cacheFile) and not forceCreate:
+        return cacheFile
+    os.makedirs(os.path.split(cacheFile)[0], exist_ok=True)
+    # Only one process creates the file, others wait for it
+    lockFile = f"{cacheFile}.lock"
+    try:
+        lock = os.open(lockFile, os.O_CREAT | os.O_EXCL)
+    except FileExistsError:
+        waitStart = time()
+        while time() - waitStart < LOCK_TIMEOUT:
+            sleep(0.1)
+            if os.path.exists(cacheFile) and not forceCreate:
+                return cacheFile
+            if not os.path.exists(lockFile):
+                break
+        # Stale lock or forced, create anyway
+        lock = None
+    try:
+        # Other processes only ever see complete files
+        base, ext = os.path.splitext(cacheFile)
+        tempFile = f"{base}.{os.getpid()}.tmp{ext}"
+        create(tempFile)
+        os.replace(tempFile, cacheFile)
+    finally:
+        if lock is not None:
+            os.close(lock)
+            os.remove(lockFile)
+    return cacheFile
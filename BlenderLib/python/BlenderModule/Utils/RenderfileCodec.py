@@ -0,0 +1,149 @@
+import struct
+import json
+
+# Faster C implementation if installed
+try:
+    import msgpack
+except ImportError:
+    msgpack = None
+
+# Decodes json (str / bytes) or binary (MessagePack) renderfiles
+def Decode(data):
+    # Json renderfiles always start with an object
+    if isinstance(data, str):
+        return json.loads(data)
+    if len(data) > 0 and data[0:1] == b"{":
+        return json.loads(data)
+    # Otherwise binary
+    if msgpack is not None:
+        return msgpack.unpackb(data, raw=False)
+    return _BinaryDecoder(data).Read()
+
+# Encodes renderfile in the given format (used for tests & benchmarks)
+def Encode(renderfile, binary):
+    if not binary:
+        return json.dumps(renderfile, separators=(",", ":")).encode("utf-8")
+    if msgpack is not None:
+        return msgpack.packb(renderfile, use_bin_type=True)
+    out = bytearray()
+    _EncodeValue(renderfile, out)
+    return bytes(out)
+
+# Minimal MessagePack decoder (subset written by the C++ renderfile writer)
+class _BinaryDecoder(object):
+
+    def __init__(self, data):
+        self.__data = memoryview(data)
+        self.__pos = 0
+
+    def __Take(self, size):
+        start = self.__pos
+        self.__pos += size
+        return self.__data[start:self.__pos]
+
+    def __Unpack(self, fmt, size):
+        return struct.unpack(fmt, self.__Take(size))[0]
+
+    def __Str(self, size):
+        return str(self.__Take(size), "utf-8")
+
+    def Read(self):
+        tag = self.__Take(1)[0]
+        # Fixed size types
+        if tag <= 0x7F:
+            return tag
+        if tag >= 0xE0:
+            return tag - 0x100
+        if 0x80 <= tag <= 0x8F:
+            return self.__Map(tag & 0x0F)
+        if 0x90 <= tag <= 0x9F:
+            return self.__Array(tag & 0x0F)
+        if 0xA0 <= tag <= 0xBF:
+            return self.__Str(tag & 0x1F)
+        # Other types
+        if tag == 0xC0:
+            return None
+        if tag == 0xC2:
+            return False
+        if tag == 0xC3:
+            return True
+        if tag == 0xCA:
+            return self.__Unpack(">f", 4)
+        if tag == 0xCB:
+            return self.__Unpack(">d", 8)
+        if tag == 0xCC:
+            return self.__Unpack(">B", 1)
+        if tag == 0xCD:
+            return self.__Unpack(">H", 2)
+        if tag == 0xCE:
+            return self.__Unpack(">I", 4)
+        if tag == 0xCF:
+            return self.__Unpack(">Q", 8)
+        if tag == 0xD0:
+            return self.__Unpack(">b", 1)
+        if tag == 0xD1:
+            return self.__Unpack(">h", 2)
+        if tag == 0xD2:
+            return self.__Unpack(">i", 4)
+        if tag == 0xD3:
+            return self.__Unpack(">q", 8)
+        if tag == 0xD9:
+            return self.__Str(self.__Unpack(">B", 1))
+        if tag == 0xDA:
+            return self.__Str(self.__Unpack(">H", 2))
+        if tag == 0xDB:
+            return self.__Str(self.__Unpack(">I", 4))
+        if tag == 0xDC:
+            return self.__Array(self.__Unpack(">H", 2))
+        if tag == 0xDD:
+            return self.__Array(self.__Unpack(">I", 4))
+        if tag == 0xDE:
+            return self.__Map(self.__Unpack(">H", 2))
+        if tag == 0xDF:
+            return self.__Map(self.__Unpack(">I", 4))
+        raise ValueError(f"Unsupported renderfile tag {tag:#x}")
+
+    def __Map(self, count):
+        return {self.Read() : self.Read() for _ in range(count)}
+
+    def __Array(self, count):
+        return [self.Read() for _ in range(count)]
+
+# Minimal MessagePack encoder (same layout as the C++ renderfile writer)
+def _EncodeValue(val, out):
+    if val is None:
+        out.append(0xC0)
+    elif isinstance(val, bool):
+        out.append(0xC3 if val else 0xC2)
+    elif isinstance(val, int):
+        out.append(0xD2)
+        out.extend(struct.pack(">i", val))
+    elif isinstance(val, float):
+        out.append(0xCB)
+        out.extend(struct.pack(">d", val))
+    elif isinstance(val, str):
+        encoded = val.encode("utf-8")
+        if len(encoded) < 32:
+            out.append(0xA0 | len(encoded))
+        elif len(encoded) <= 0xFF:
+            out.append(0xD9)
+            out.append(len(encoded))
+        elif len(encoded) <= 0xFFFF:
+            out.append(0xDA)
+            out.extend(struct.pack(">H", len(encoded)))
+        else:
+            out.append(0xDB)
+            out.extend(struct.pack(">I", len(encoded)))
+        out.extend(encoded)
+    elif isinstance(val, (list, tuple)):
+        out.append(0xDD)
+        out.extend(struct.pack(">I", len(val)))
+        [_EncodeValue(entry, out) for entry in val]
+    elif isinstance(val, dict):
+        out.append(0xDF)
+        out.extend(struct.pack(">I", len(val)))
+        for key, entry in val.items():
+            _EncodeValue(key, out)
+            _EncodeValue(entry, out)
+    else:
+        raise ValueError(f"Unsupported renderfile value {type(val)}")
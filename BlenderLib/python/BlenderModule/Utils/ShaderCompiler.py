@@ -1,24 +1,101 @@
 from .Logger import GetLogger
 from . import FileName, FileDir, FullPath
 
+from .FileCache import CachedFile
+
+from hashlib import sha1
+from time import time
+
 import os
 import sys
 import glob
 
 logger = GetLogger()
 
+# Created on first compile only
+__compiler = None
+# Determined on first cache lookup only
+__compilerVersion = None
+
 # Compile and store every osl shader in a folder
-def CompileFolder(shaderFolder, modulePath, forceCompile):
+def CompileFolder(shaderFolder, modulePath, forceCompile, cacheFolder=None):
     logger.info(f"Compiling shaders in folder {shaderFolder}")
     # Glob all osl files, compile and store them
     for oslShader in glob.glob(shaderFolder + "/*.osl"):
         compiledFile = f"{FileDir(oslShader)}/{FileName(oslShader)}.oso"
-        if not os.path.exists(compiledFile) or forceCompile:
-            bytecode = CompileFile(FullPath(oslShader), modulePath)
-            StoreBytecode(bytecode, compiledFile)
+        # Without cache only compile missing shaders
+        if cacheFolder is None:
+            if not os.path.exists(compiledFile) or forceCompile:
+                bytecode = __TimedCompile(FullPath(oslShader), modulePath)
+                StoreBytecode(bytecode, compiledFile)
+        else:
+            bytecode = CachedBytecode(FullPath(oslShader), modulePath, cacheFolder, forceCompile)
+            # Only replace outdated compiled shaders
+            if __ReadFile(compiledFile) != bytecode:
+                StoreBytecode(bytecode, compiledFile)
+
+# Returns bytecode of shader, compiles only if source changed
+def CachedBytecode(sourceFile, modulePath, cacheFolder, forceCompile):
+    # Cache is keyed by shader source & the compiler that creates the bytecode
+    with open(sourceFile, "rb") as codeFile:
+        sourceHash = sha1(codeFile.read() + CompilerVersion(modulePath).encode("utf-8")).hexdigest()
+    cacheFile = f"{cacheFolder}/shaders/{FileName(sourceFile)}_{sourceHash}.oso"
+    CachedFile(cacheFile, lambda tempFile: StoreBytecode(__TimedCompile(sourceFile, modulePath), tempFile, False), forceCompile)
+    return __ReadFile(cacheFile)
+
+# Compiles & logs the compile time
+def __TimedCompile(sourceFile, modulePath):
+    compileStart = time()
+    bytecode = CompileFile(sourceFile, modulePath)
+    logger.warning(f"Compiled shader {FileName(sourceFile)} in {time() - compileStart:.2f}s")
+    return bytecode
+
+# File content, None if it doesn't exist
+def __ReadFile(filePath):
+    try:
+        with open(filePath, "r") as readFile:
+            return readFile.read()
+    except OSError:
+        return None
 
 # Compiles osl shader and returns bytecode
 def CompileFile(sourceFile, modulePath):
+    global __compiler
+    if __compiler is None:
+        __compiler = __CreateCompiler(modulePath)
+
+    # Open shader code
+    codeFile = open(sourceFile, "r")
+    sourceCode = codeFile.read()
+    codeFile.close()
+
+    # Compile and return code
+    logger.info(f"Compiling shader {sourceFile}")
+    return __compiler.compile_buffer(sourceCode)
+
+# Version of appleseed & its osl compiler (library & standard headers)
+def CompilerVersion(modulePath):
+    global __compilerVersion
+    if __compilerVersion is None:
+        appleseed, oslStdPath = __ImportAppleseed(modulePath)
+        getVersion = getattr(appleseed, "get_lib_version", None)
+        version = [getVersion() if getVersion is not None else "unknown"]
+        # Compiler is built into the library, rebuilt libraries keep their version
+        libFile = getattr(appleseed, "__file__", None)
+        if libFile is not None and os.path.exists(libFile):
+            libInfo = os.stat(libFile)
+            version.append(f"{libInfo.st_size}_{libInfo.st_mtime_ns}")
+        # Shaders include the standard headers
+        for stdPath in ([oslStdPath] if isinstance(oslStdPath, str) else oslStdPath):
+            for header in sorted(glob.glob(f"{stdPath}/*.h")):
+                with open(header, "rb") as headerFile:
+                    version.append(sha1(headerFile.read()).hexdigest())
+        __compilerVersion = "_".join(str(part) for part in version)
+        logger.info(f"Shader compiler version {__compilerVersion}")
+    return __compilerVersion
+
+# Imports appleseed, returns its module & the osl standard header paths
+def __ImportAppleseed(modulePath):
     # Store original path
     tempPath = os.environ["PATH"]
     pyDir = FullPath(f"{modulePath}/appleseed/lib")
@@ -31,33 +108,30 @@ def CompileFile(sourceFile, modulePath):
     # Modify env path and import appleseed
     binDir = path_utils.get_appleseed_bin_dir_path()
     os.environ["PATH"] += os.pathsep + binDir
-    from appleseed._appleseedpython3 import ShaderCompiler
+    import appleseed._appleseedpython3 as appleseed
 
     # Undo modifications
     os.environ["PATH"] = tempPath
     sys.path.remove(modulePath)
     sys.path.remove(pyDir)
 
-    # Create shader compiler
-    oslStdPath = path_utils.get_stdosl_paths()
-    compiler = ShaderCompiler(oslStdPath)
+    return appleseed, path_utils.get_stdosl_paths()
 
-    # Open shader code
-    codeFile = open(sourceFile, "r")
-    sourceCode = codeFile.read()
-    codeFile.close()
-
-    # Compile and return code
-    logger.info(f"Compiling shader {sourceFile}")
-    return compiler.compile_buffer(sourceCode)
+# Imports appleseed & creates shader compiler
+def __CreateCompiler(modulePath):
+    appleseed, oslStdPath = __ImportAppleseed(modulePath)
+    return appleseed.ShaderCompiler(oslStdPath)
 
 # Stores compiled shader in file
-def StoreBytecode(bytecode, codeFile):
+def StoreBytecode(bytecode, codeFile, replace=True):
     logger.info(f"Storing compiled shader {codeFile}")
-    # Write bytecode out to file
-    shaderFile = open(codeFile, "w")
+    # Write to temporary file & replace, other processes may read it
+    tempFile = f"{codeFile}.{os.getpid()}.tmp" if replace else codeFile
+    shaderFile = open(tempFile, "w")
     shaderFile.write(bytecode)
     shaderFile.close()
+    if replace:
+        os.replace(tempFile, codeFile)
 
 # Ensures blenderseed is extracted & available
 def EnsureInstalled(modulePath, pluginPath):
@@ -1,6 +1,9 @@
+from .FileCache import CacheKey, CachedFile
 from .Logger import GetLogger
 from . import FileName, FileDir, FullPath
 
+from time import time
+
 import os
 import sys
 
@@ -9,13 +12,42 @@ logger = GetLogger()
 colorSpaces = ["linear", "sRGB", "Rec709"]
 colorDepths = ["default", "uint8", "sint8", "uint16", "sint16", "half", "float"]
 
+# Imported on first conversion only
+__makeTexture = None
+
 # Converts a given image & returns path to new texture
-def ConvertTexture(imageFile, colorSpace, colorDepth, modulePath):
-    # Don't convert if texture exists
-    outPath = f"{FileDir(imageFile)}/{FileName(imageFile)}.tx"
-    if os.path.exists(outPath):
-        return outPath
+def ConvertTexture(imageFile, colorSpace, colorDepth, modulePath, cacheFolder=None):
+    colorSpace = colorSpace if colorSpace in colorSpaces else "sRGB"
+    colorDepth = colorDepth if colorDepth in colorDepths else "default"
 
+    # Without cache the texture is stored next to the image
+    if cacheFolder is None:
+        # Don't convert if texture exists
+        outPath = f"{FileDir(imageFile)}/{FileName(imageFile)}.tx"
+        if os.path.exists(outPath):
+            return outPath
+        return __TimedConvert(imageFile, outPath, colorSpace, colorDepth, modulePath)
+
+    # Cache is keyed by image (changes with size / modification) & conversion
+    imageStat = os.stat(imageFile)
+    key = CacheKey(FullPath(imageFile), imageStat.st_size, imageStat.st_mtime_ns, colorSpace, colorDepth)
+    cacheFile = f"{cacheFolder}/textures/{FileName(imageFile)}_{key}.tx"
+    return CachedFile(cacheFile, lambda tempFile: __TimedConvert(imageFile, tempFile, colorSpace, colorDepth, modulePath))
+
+# Converts & logs the conversion time
+def __TimedConvert(imageFile, outPath, colorSpace, colorDepth, modulePath):
+    global __makeTexture
+    if __makeTexture is None:
+        __makeTexture = __ImportMakeTexture(modulePath)
+
+    convertStart = time()
+    logger.info(f"Converting texture {imageFile} ({colorSpace}, {colorDepth})")
+    __makeTexture(imageFile, outPath, colorSpace, colorDepth)
+    logger.warning(f"Converted texture {FileName(imageFile)} in {time() - convertStart:.2f}s")
+    return outPath
+
+# Imports appleseed texture conversion
+def __ImportMakeTexture(modulePath):
     # Store original path
     tempPath = os.environ["PATH"]
     pyDir = FullPath(f"{modulePath}/appleseed/lib")
@@ -34,10 +66,4 @@ def ConvertTexture(imageFile, colorSpace, colorDepth, modulePath):
     os.environ["PATH"] = tempPath
     sys.path.remove(modulePath)
     sys.path.remove(pyDir)
-
-    # Convert texture & return new file
-    colorSpace = colorSpace if colorSpace in colorSpaces else "sRGB"
-    colorDepth = colorDepth if colorDepth in colorDepths else "default"
-    logger.info(f"Converting texture {imageFile} ({colorSpace}, {colorDepth})")
-    oiio_make_texture(imageFile, outPath, colorSpace, colorDepth)
-    return outPath
+    return oiio_make_texture
@@ -0,0 +1,71 @@
+from struct import pack, unpack, calcsize
+from time import sleep
+
+import socket
+
+# Commands sent by the C++ side (see WorkerChannel.h)
+CHANNEL_RENDER = 1
+CHANNEL_RESET = 2
+CHANNEL_CLOSE = 3
+CHANNEL_PREWARM = 4
+
+# Command & payload size / status, memory (MB) & startup time (s)
+HEADER_FORMAT = "<IQ"
+REPLY_FORMAT = "<Idd"
+# Connection attempts before the process gives up (native side restarts it)
+CONNECT_RETRIES = 10
+CONNECT_DELAY = 0.5
+
+# Connection of a render process to the native renderer
+class WorkerChannel(object):
+
+    def __init__(self, port, index):
+        self.__socket = None
+        # Listener may not accept yet
+        for attempt in range(CONNECT_RETRIES + 1):
+            try:
+                self.__socket = socket.create_connection(("127.0.0.1", port), CONNECT_DELAY * 2)
+                break
+            except OSError:
+                if attempt == CONNECT_RETRIES:
+                    raise
+                sleep(CONNECT_DELAY)
+        self.__socket.settimeout(None)
+        self.__socket.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        # Identify process first
+        self.__socket.sendall(pack("<I", index))
+
+    def __del__(self):
+        self.Close()
+
+    # Blocks until the next command, (CHANNEL_CLOSE, None) if the connection is gone
+    def Receive(self):
+        header = self.__ReadExactly(calcsize(HEADER_FORMAT))
+        if header is None:
+            return (CHANNEL_CLOSE, None)
+        command, size = unpack(HEADER_FORMAT, header)
+        payload = self.__ReadExactly(size)
+        if payload is None:
+            return (CHANNEL_CLOSE, None)
+        return (command, payload)
+
+    # Answers the last command
+    def Reply(self, success, memory, startup):
+        self.__socket.sendall(pack(REPLY_FORMAT, 0 if success else 1, memory, startup))
+
+    def Close(self):
+        if self.__socket is not None:
+            self.__socket.close()
+            self.__socket = None
+
+    # Reads the given amount of bytes, None on disconnect
+    def __ReadExactly(self, size):
+        data = bytearray(size)
+        view = memoryview(data)
+        received = 0
+        while received < size:
+            count = self.__socket.recv_into(view[received:], size - received)
+            if count == 0:
+                return None
+            received += count
+        return bytes(data)
@@ -1,4 +1,4 @@
-__all__ = ["Importer", "Logger", "OutputMuter", "ShaderCompiler", "TextureConverter"]
+__all__ = ["FileCache", "Importer", "Logger", "OutputMuter", "RenderfileCodec", "ShaderCompiler", "TextureConverter", "WorkerChannel"]
 
 import os
 import sys
@@ -1,4 +1,14 @@
+#include <map>
+#include <deque>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <condition_variable>
+
 #include <BlenderRenderer.h>
+#include <WorkerChannel.h>
 
 #pragma warning(push, 0)
 #define HAVE_SNPRINTF
@@ -10,6 +20,10 @@
 
 using namespace boost::python;
 
+// Spawning & loading blender takes a while
+#define CHANNEL_CONNECT_TIMEOUT 120.0f
+#define CHANNEL_RESET_TIMEOUT 30.0f
+
 namespace Blender
 {
 	//---------------------------------------
@@ -34,6 +48,65 @@ namespace Blender
 		}
 	};
 
+	//---------------------------------------
+	// Progress of a submitted renderfile
+	//---------------------------------------
+	enum class RenderStatus
+	{
+		Queued,
+		Running,
+		Rendered,
+		Rejected,
+		Failed,
+		Cancelled
+	};
+
+	//---------------------------------------
+	// Shared state of a render future
+	//---------------------------------------
+	struct RenderFuture::State
+	{
+		std::string Renderfile;
+		uint32_t Command;
+		float Timeout;
+		bool IsDelta;
+
+		RenderStatus Status;
+		std::chrono::steady_clock::time_point Started;
+		std::chrono::steady_clock::time_point Finished;
+		std::vector<std::function<void(bool)>> Callbacks;
+		std::mutex Lock;
+		std::condition_variable Done;
+
+		inline bool IsDone() const
+		{
+			return Status != RenderStatus::Queued && Status != RenderStatus::Running;
+		}
+
+		// Finishes the render & notifies waiting threads
+		bool Complete(RenderStatus result, bool onlyQueued = false)
+		{
+			std::vector<std::function<void(bool)>> completed;
+			{
+				std::lock_guard<std::mutex> lock(Lock);
+				// Cancelling requires the render to not have started
+				if (onlyQueued && Status != RenderStatus::Queued)
+					return false;
+				Status = result;
+				Finished = std::chrono::steady_clock::now();
+				completed.swap(Callbacks);
+				// Renderfile is not needed anymore
+				std::string().swap(Renderfile);
+			}
+			Done.notify_all();
+			for (auto& callback : completed)
+			{
+				callback(result == RenderStatus::Rendered);
+			}
+			return true;
+		}
+	};
+
 	//---------------------------------------
 	// Implementation class
 	//---------------------------------------
@@ -46,7 +119,58 @@ namespace Blender
 
 		object blenderModule;
 		object renderManager;
-		object logger;
+
+		// Native connections, used without the GIL
+		ChannelListener listener;
+		std::vector<WorkerChannel> channels;
+		std::vector<double> lastMemory;
+		std::vector<double> lastStartup;
+		int memoryLimit;
+		float startupSaved;
+		std::mutex statsLock;
+
+		std::map<int, std::map<std::string, std::chrono::steady_clock::time_point>> performanceTimers;
+		std::mutex performanceLock;
+
+		// Submitted renderfiles, processed in order per render process
+		std::vector<std::deque<std::shared_ptr<RenderFuture::State>>> submitted;
+		std::vector<std::thread> dispatchers;
+		std::vector<float> queuedCost;
+		std::mutex submitLock;
+		std::condition_variable submitChanged;
+		bool isClosing;
+
+		//---------------------------------------
+		// Methods
+		//---------------------------------------
+
+		// Makes sure the process of the thread is connected
+		bool X_Connect(int thread)
+		{
+			if (channels[thread].IsConnected())
+				return true;
+			std::unique_ptr<ChannelSocket> connected = listener.Accept(thread, CHANNEL_CONNECT_TIMEOUT);
+			if (!connected)
+				return false;
+			channels[thread].Connect(std::move(connected));
+			return true;
+		}
+
+		// Replaces the process of the thread (stuck, crashed or too large)
+		void X_Restart(int thread)
+		{
+			channels[thread].Disconnect();
+			listener.Forget(thread);
+			GILLock scope;
+			try
+			{
+				renderManager.attr("UnloadProcess")(thread);
+			}
+			catch (const error_already_set&)
+			{
+				PyErr_Print();
+			}
+		}
 
 	public:
 		//---------------------------------------
@@ -58,52 +182,256 @@ namespace Blender
 			int thread
 		)
 		{
-			try
+			std::lock_guard<std::mutex> lock(performanceLock);
+			auto& timers = performanceTimers[thread];
+			auto found = timers.find(what);
+			// Start timer or log duration
+			if (found == timers.end())
 			{
-				logger.attr("LogPerformance")(what, thread);
+				timers[what] = std::chrono::steady_clock::now();
 			}
-			catch (const error_already_set&)
+			else
 			{
-				PyErr_Print();
+				std::chrono::duration<double> duration = std::chrono::steady_clock::now() - found->second;
+				std::cout << "*************************************************************" << std::endl;
+				std::cout << "[Thread " << thread << "] " << what << " duration: " << duration.count() << std::endl;
+				std::cout << "*************************************************************" << std::endl;
+				timers.erase(found);
 			}
 		}
 
-		void ProcessRenderfile(
+		// Blocks until rendered, failed renders are not repeated
+		RenderStatus X_Render(
 			const std::string& renderfile,
 			float timeout,
+			int thread,
+			bool isDelta
+		)
+		{
+			if (renderfile.empty())
+				return RenderStatus::Rendered;
+
+			// Process may still be starting up
+			if (!X_Connect(thread))
+			{
+				std::cout << "Render process " << thread << " did not connect, restarting" << std::endl;
+				X_Restart(thread);
+				return RenderStatus::Failed;
+			}
+
+			// Blocks until rendering is complete
+			WorkerChannel::Reply reply = channels[thread].Request(CHANNEL_RENDER, renderfile, timeout);
+			if (reply.Valid)
+			{
+				std::lock_guard<std::mutex> lock(statsLock);
+				lastMemory[thread] = reply.MemoryMB;
+				lastStartup[thread] = std::max(lastStartup[thread], reply.StartupTime);
+				// Process has no scene to apply the delta to
+				if (!reply.Success)
+					return isDelta ? RenderStatus::Rejected : RenderStatus::Failed;
+				return RenderStatus::Rendered;
+			}
+
+			// If rendering is stuck, reload process (caller decides what to repeat)
+			std::cout << "Render process " << thread << " timed out after " << timeout << "s, restarting" << std::endl;
+			X_Restart(thread);
+			return RenderStatus::Failed;
+		}
+
+		// Fills texture cache, doesn't change the scene
+		bool X_Prewarm(
+			const std::string& request,
+			float timeout,
 			int thread
 		)
 		{
-			try
+			if (!X_Connect(thread))
+			{
+				X_Restart(thread);
+				return false;
+			}
+
+			WorkerChannel::Reply reply = channels[thread].Request(CHANNEL_PREWARM, request, timeout);
+			if (!reply.Valid)
 			{
-				if (!renderfile.empty())
+				// Process is stuck, new one converts on demand
+				X_Restart(thread);
+				return false;
+			}
+			return reply.Success;
+		}
+
+		// Clears the scene in place, recycles the process if that fails or it grew too large
+		RenderStatus X_Reset(
+			float timeout,
+			int thread
+		)
+		{
+			double memory;
+			{
+				std::lock_guard<std::mutex> lock(statsLock);
+				memory = lastMemory[thread];
+			}
+			if (!channels[thread].IsConnected() || (memoryLimit > 0 && memory > memoryLimit))
+			{
+				X_Restart(thread);
+				return RenderStatus::Rendered;
+			}
+
+			WorkerChannel::Reply reply = channels[thread].Request(CHANNEL_RESET, std::string(), timeout);
+			if (!reply.Valid)
+			{
+				X_Restart(thread);
+				return RenderStatus::Rendered;
+			}
+
+			// Spawning & setup were avoided
+			std::lock_guard<std::mutex> lock(statsLock);
+			lastMemory[thread] = reply.MemoryMB;
+			lastStartup[thread] = std::max(lastStartup[thread], reply.StartupTime);
+			startupSaved += static_cast<float>(lastStartup[thread]);
+			return RenderStatus::Rendered;
+		}
+
+		// Renders submitted renderfiles of one process
+		void X_DispatchLoop(int thread)
+		{
+			while (true)
+			{
+				std::shared_ptr<RenderFuture::State> next;
 				{
-					renderManager.attr("ProcessRenderfile")(renderfile, timeout, thread);
+					std::unique_lock<std::mutex> lock(submitLock);
+					submitChanged.wait(lock, [&] { return isClosing || !submitted[thread].empty(); });
+					if (isClosing)
+						break;
+					next = std::move(submitted[thread].front());
+					submitted[thread].pop_front();
 				}
+
+				// Skip cancelled renderfiles
+				bool isQueued;
+				{
+					std::lock_guard<std::mutex> lock(next->Lock);
+					isQueued = next->Status == RenderStatus::Queued;
+					if (isQueued)
+					{
+						next->Status = RenderStatus::Running;
+						next->Started = std::chrono::steady_clock::now();
+					}
+				}
+
+				if (isQueued)
+				{
+					RenderStatus result;
+					switch (next->Command)
+					{
+					case CHANNEL_RENDER:
+						result = X_Render(next->Renderfile, next->Timeout, thread, next->IsDelta);
+						break;
+					case CHANNEL_RESET:
+						result = X_Reset(next->Timeout, thread);
+						break;
+					default:
+						result = X_Prewarm(next->Renderfile, next->Timeout, thread) ? RenderStatus::Rendered : RenderStatus::Failed;
+						break;
+					}
+					next->Complete(result);
+				}
+
+				// Process has less work left
+				std::lock_guard<std::mutex> lock(submitLock);
+				queuedCost[thread] = std::max(0.0f, queuedCost[thread] - next->Timeout);
 			}
-			catch (const error_already_set&)
+
+			// Nothing is rendered anymore
+			std::lock_guard<std::mutex> lock(submitLock);
+			for (auto& remaining : submitted[thread])
 			{
-				PyErr_Print();
+				remaining->Complete(RenderStatus::Cancelled, true);
 			}
+			submitted[thread].clear();
 		}
 
-		void UnloadProcess(int thread)
+		RenderFuture SubmitRenderfile(
+			const std::string& renderfile,
+			float timeout,
+			int thread,
+			bool isDelta,
+			uint32_t command = CHANNEL_RENDER
+		)
 		{
-			try
+			std::shared_ptr<RenderFuture::State> state = std::make_shared<RenderFuture::State>();
+			state->Renderfile = renderfile;
+			state->Command = command;
+			state->Timeout = timeout;
+			state->IsDelta = isDelta;
+			state->Status = RenderStatus::Queued;
+
+			// Handed to the dispatcher of the process
 			{
-				renderManager.attr("UnloadProcess")(thread);
+				std::lock_guard<std::mutex> lock(submitLock);
+				submitted[thread].push_back(state);
+				queuedCost[thread] += timeout;
 			}
-			catch (const error_already_set&)
+			submitChanged.notify_all();
+			return RenderFuture(state);
+		}
+
+		int SelectWorker(
+			int preferred,
+			float cost
+		)
+		{
+			std::lock_guard<std::mutex> lock(submitLock);
+			// Timeouts scale with the camera count, used as cost estimate
+			int least = static_cast<int>(std::min_element(queuedCost.begin(), queuedCost.end()) - queuedCost.begin());
+			// Preferred process holds the scene already, keep it unless it is clearly busier
+			if (preferred >= 0 && preferred < static_cast<int>(queuedCost.size()) &&
+				queuedCost[preferred] <= queuedCost[least] + cost)
 			{
-				PyErr_Print();
+				return preferred;
 			}
+			return least;
+		}
+
+		inline int GetWorkerCount() const
+		{
+			return static_cast<int>(channels.size());
+		}
+
+		void UnloadProcess(int thread)
+		{
+			X_Restart(thread);
+		}
+
+		RenderFuture ResetProcess(int thread)
+		{
+			// Queued behind pending renders & prewarms, only the dispatcher uses the channel
+			return SubmitRenderfile(std::string(), CHANNEL_RESET_TIMEOUT, thread, false, CHANNEL_RESET);
+		}
+
+		float PopStartupSaved()
+		{
+			std::lock_guard<std::mutex> lock(statsLock);
+			float saved = startupSaved;
+			startupSaved = 0.0f;
+			return saved;
 		}
 
 		//---------------------------------------
 		// Constructors
 		//---------------------------------------
 
-		Renderer_impl(int workerCount)
+		Renderer_impl(int workerCount, int memoryLimit) :
+			listener(),
+			channels(workerCount),
+			lastMemory(workerCount, 0.0),
+			lastStartup(workerCount, 0.0),
+			memoryLimit(memoryLimit),
+			startupSaved(0.0f),
+			submitted(workerCount),
+			queuedCost(workerCount, 0.0f),
+			isClosing(false)
 		{
 			try
 			{
@@ -114,23 +442,49 @@ namespace Blender
 				object utils = import("BlenderModule.Utils");
 				utils.attr("SetupMultiprocessing")();
 
-				// Store logger & render manager instance
-				logger = import("BlenderModule.Utils.Logger");
+				// Processes connect back to the listener
 				object renderModule = import("BlenderModule.Managers.RenderManager");
-				renderManager = renderModule.attr("RenderManager")(workerCount);
+				renderManager = renderModule.attr("RenderManager")(workerCount, memoryLimit, listener.GetPort());
 			}
 			catch (const error_already_set&)
 			{
 				PyErr_Print();
 			}
+
+			// One dispatcher per render process
+			for (int i = 0; i < workerCount; ++i)
+			{
+				dispatchers.emplace_back(&Renderer_impl::X_DispatchLoop, this, i);
+			}
 		}
 
 		~Renderer_impl()
 		{
+			// Stop dispatching, pending renderfiles are cancelled
+			{
+				std::lock_guard<std::mutex> lock(submitLock);
+				isClosing = true;
+			}
+			submitChanged.notify_all();
+			for (auto& dispatcher : dispatchers)
+			{
+				dispatcher.join();
+			}
+
+			// Let processes exit on their own
+			for (auto& channel : channels)
+			{
+				channel.Request(CHANNEL_CLOSE, std::string(), 0.0f);
+				channel.Disconnect();
+			}
+
+			GILLock scope;
 			try
 			{
 				// Cleanup manager & interpreter
 				renderManager.attr("DeleteManager")();
+				renderManager = object();
+				blenderModule = object();
 			}
 			catch (const error_already_set&)
 			{
@@ -139,6 +493,135 @@ namespace Blender
 		}
 	};
 
+	//---------------------------------------
+	// Future has a submitted renderfile
+	//---------------------------------------
+	bool RenderFuture::IsValid() const
+	{
+		return futureState != NULL;
+	}
+
+	//---------------------------------------
+	// Future is done (rendered or not)
+	//---------------------------------------
+	bool RenderFuture::IsReady() const
+	{
+		if (!futureState)
+			return true;
+		std::lock_guard<std::mutex> lock(futureState->Lock);
+		return futureState->IsDone();
+	}
+
+	//---------------------------------------
+	// Future was cancelled before rendering
+	//---------------------------------------
+	bool RenderFuture::IsCancelled() const
+	{
+		if (!futureState)
+			return false;
+		std::lock_guard<std::mutex> lock(futureState->Lock);
+		return futureState->Status == RenderStatus::Cancelled;
+	}
+
+	//---------------------------------------
+	// Future timed out or its process crashed
+	//---------------------------------------
+	bool RenderFuture::HasFailed() const
+	{
+		if (!futureState)
+			return false;
+		std::lock_guard<std::mutex> lock(futureState->Lock);
+		return futureState->Status == RenderStatus::Failed;
+	}
+
+	//---------------------------------------
+	// Seconds the process worked on it
+	//---------------------------------------
+	float RenderFuture::GetRenderTime() const
+	{
+		if (!futureState)
+			return 0.0f;
+		std::lock_guard<std::mutex> lock(futureState->Lock);
+		if (!futureState->IsDone() || futureState->Started == std::chrono::steady_clock::time_point())
+			return 0.0f;
+		return std::chrono::duration<float>(futureState->Finished - futureState->Started).count();
+	}
+
+	//---------------------------------------
+	// Wait for rendering to complete
+	//---------------------------------------
+	bool RenderFuture::Wait() const
+	{
+		if (!futureState)
+			return false;
+		std::unique_lock<std::mutex> lock(futureState->Lock);
+		futureState->Done.wait(lock, [&] { return futureState->IsDone(); });
+		return futureState->Status == RenderStatus::Rendered;
+	}
+
+	//---------------------------------------
+	// Wait for rendering with timeout
+	//---------------------------------------
+	bool RenderFuture::WaitFor(
+		float seconds
+	) const
+	{
+		if (!futureState)
+			return true;
+		std::unique_lock<std::mutex> lock(futureState->Lock);
+		return futureState->Done.wait_for(lock, std::chrono::duration<float>(seconds), [&] { return futureState->IsDone(); });
+	}
+
+	//---------------------------------------
+	// Cancel if not yet rendering
+	//---------------------------------------
+	bool RenderFuture::Cancel()
+	{
+		if (!futureState)
+			return false;
+		// Dispatcher skips it
+		return futureState->Complete(RenderStatus::Cancelled, true);
+	}
+
+	//---------------------------------------
+	// Register completion callback
+	//---------------------------------------
+	void RenderFuture::OnComplete(
+		const std::function<void(bool)>& callback
+	)
+	{
+		if (!futureState)
+			return;
+		{
+			std::lock_guard<std::mutex> lock(futureState->Lock);
+			if (!futureState->IsDone())
+			{
+				futureState->Callbacks.push_back(callback);
+				return;
+			}
+		}
+		// Already done, call directly
+		callback(futureState->Status == RenderStatus::Rendered);
+	}
+
+	//---------------------------------------
+	// Empty future
+	//---------------------------------------
+	RenderFuture::RenderFuture() :
+		futureState()
+	{
+	}
+
+	//---------------------------------------
+	// Future of a submitted renderfile
+	//---------------------------------------
+	RenderFuture::RenderFuture(
+		const std::shared_ptr<State>& state
+	) :
+		futureState(state)
+	{
+	}
+
 	//---------------------------------------
 	// Forward performance logging
 	//---------------------------------------
@@ -147,21 +630,64 @@ namespace Blender
 		int thread
 	)
 	{
-		GILLock scope;
 		rendererImpl->LogPerformance(what, thread);
 	}
 
 	//---------------------------------------
-	// Forward renderfile processing
+	// Blocking renderfile processing
+	//---------------------------------------
+	bool BlenderRenderer::ProcessRenderfile(
+		const std::string& renderfile,
+		float timeout,
+		int thread,
+		bool isDelta
+	)
+	{
+		return rendererImpl->SubmitRenderfile(renderfile, timeout, thread, isDelta).Wait();
+	}
+
+	//---------------------------------------
+	// Forward renderfile submission
 	//---------------------------------------
-	void BlenderRenderer::ProcessRenderfile(
+	RenderFuture BlenderRenderer::SubmitRenderfile(
 		const std::string& renderfile,
 		float timeout,
+		int thread,
+		bool isDelta
+	)
+	{
+		return rendererImpl->SubmitRenderfile(renderfile, timeout, thread, isDelta);
+	}
+
+	//---------------------------------------
+	// Forward texture prewarming
+	//---------------------------------------
+	RenderFuture BlenderRenderer::PrewarmTextures(
+		const std::string& request,
+		float timeout,
 		int thread
 	)
 	{
-		GILLock scope;
-		rendererImpl->ProcessRenderfile(renderfile, timeout, thread);
+		return rendererImpl->SubmitRenderfile(request, timeout, thread, false, CHANNEL_PREWARM);
+	}
+
+	//---------------------------------------
+	// Forward load aware process selection
+	//---------------------------------------
+	int BlenderRenderer::SelectWorker(
+		int preferred,
+		float cost
+	)
+	{
+		return rendererImpl->SelectWorker(preferred, cost);
+	}
+
+	//---------------------------------------
+	// Forward process count
+	//---------------------------------------
+	int BlenderRenderer::GetWorkerCount() const
+	{
+		return rendererImpl->GetWorkerCount();
 	}
 
 	//---------------------------------------
@@ -171,15 +697,33 @@ namespace Blender
 		int thread
 	)
 	{
-		GILLock scope;
 		rendererImpl->UnloadProcess(thread);
 	}
 
+	//---------------------------------------
+	// Forward scene reset
+	//---------------------------------------
+	RenderFuture BlenderRenderer::ResetProcess(
+		int thread
+	)
+	{
+		return rendererImpl->ResetProcess(thread);
+	}
+
+	//---------------------------------------
+	// Forward saved startup time
+	//---------------------------------------
+	float BlenderRenderer::PopStartupSaved()
+	{
+		return rendererImpl->PopStartupSaved();
+	}
+
 	//---------------------------------------
 	// Forward API creation
 	//---------------------------------------
 	BlenderRenderer::BlenderRenderer(
-		int workerCount
+		int workerCount,
+		int memoryLimit
 	)
 	{
 		// If Python not yet initialized
@@ -196,7 +740,7 @@ namespace Blender
 
 		// Create implemenation
 		PyGILState_Ensure();
-		rendererImpl = new Renderer_impl(workerCount);
+		rendererImpl = new Renderer_impl(workerCount, memoryLimit);
 
 		// Manually release GIL
 		auto mainThread = PyThreadState_Get();
@@ -208,7 +752,7 @@ namespace Blender
 	//---------------------------------------
 	BlenderRenderer::~BlenderRenderer()
 	{
-		GILLock scope;
+		// Takes the GIL itself
 		delete rendererImpl;
 		rendererImpl = NULL;
 	}
@@ -0,0 +1,339 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif //_WIN32
+
+#pragma warning(push, 0)
+#include <boost/filesystem.hpp>
+
+#include <Helpers/PathUtils.h>
+#include <Helpers/PhysxManager.h>
+#include <Helpers/PxSpawner.h>
+
+#include <Meshes/PxMeshConvex.h>
+#include <Meshes/PxMeshTriangle.h>
+#pragma warning(pop)
+
+#ifndef PX_BENCHMARK_DATA
+#define PX_BENCHMARK_DATA "benchmark/data"
+#endif //PX_BENCHMARK_DATA
+
+using namespace physx;
+
+//---------------------------------------
+// Sweep & simulation parameters
+//---------------------------------------
+struct BenchmarkOptions
+{
+	ModifiablePath ScenePath = ModifiablePath(PX_BENCHMARK_DATA) / "room.obj";
+	ModifiablePath ObjectsPath = ModifiablePath(PX_BENCHMARK_DATA) / "objects";
+	std::vector<int> Counts = { 25, 50, 100, 200 };
+	std::vector<bool> CCD = { true, false };
+	std::vector<bool> PCM = { true, false };
+	std::vector<bool> Stabilization = { true, false };
+	std::vector<PxBroadPhaseType::Enum> BroadPhases = { PxBroadPhaseType::eABP, PxBroadPhaseType::eSAP, PxBroadPhaseType::eMBP };
+	std::vector<bool> OverlapFree = { false, true };
+	float CollisionError = 0.0f;
+	int Steps = 2000;
+	int SettleSteps = 20;
+	int Threads = 0;
+	int Repeats = 1;
+	unsigned int Seed = 42;
+};
+
+//---------------------------------------
+// Resident memory of the process
+//---------------------------------------
+static size_t ResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.WorkingSetSize;
+	return 0;
+#else
+	std::ifstream statm("/proc/self/statm");
+	size_t pages = 0, resident = 0;
+	statm >> pages >> resident;
+	return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif //_WIN32
+}
+
+static std::vector<std::string> SplitList(const std::string& list)
+{
+	std::vector<std::string> items;
+	std::stringstream stream(list);
+	std::string item;
+	while (std::getline(stream, item, ','))
+	{
+		if (!item.empty())
+			items.push_back(item);
+	}
+	return items;
+}
+
+static std::vector<bool> ParseSwitches(const std::string& list)
+{
+	std::vector<bool> switches;
+	for (const auto& item : SplitList(list))
+	{
+		switches.push_back(item == "on" || item == "1" || item == "true");
+	}
+	return switches;
+}
+
+static const char* BroadPhaseName(PxBroadPhaseType::Enum type)
+{
+	switch (type)
+	{
+	case PxBroadPhaseType::eSAP: return "sap";
+	case PxBroadPhaseType::eMBP: return "mbp";
+	case PxBroadPhaseType::eABP: return "abp";
+	default: return "gpu";
+	}
+}
+
+//---------------------------------------
+// Command line, false if invalid
+//---------------------------------------
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+	// Malformed numbers are invalid as well
+	try
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg(argv[i]);
+			if (arg == "--help" || i + 1 >= argc)
+				return false;
+			std::string value(argv[++i]);
+
+			if (arg == "--scene")
+				options.ScenePath = value;
+			else if (arg == "--objects")
+				options.ObjectsPath = value;
+			else if (arg == "--counts")
+			{
+				options.Counts.clear();
+				for (const auto& item : SplitList(value))
+					options.Counts.push_back(std::max(std::stoi(item), 1));
+			}
+			else if (arg == "--ccd")
+				options.CCD = ParseSwitches(value);
+			else if (arg == "--pcm")
+				options.PCM = ParseSwitches(value);
+			else if (arg == "--stabilization")
+				options.Stabilization = ParseSwitches(value);
+			else if (arg == "--broadphase")
+			{
+				options.BroadPhases.clear();
+				for (const auto& item : SplitList(value))
+				{
+					if (item == "abp")
+						options.BroadPhases.push_back(PxBroadPhaseType::eABP);
+					else if (item == "sap")
+						options.BroadPhases.push_back(PxBroadPhaseType::eSAP);
+					else if (item == "mbp")
+						options.BroadPhases.push_back(PxBroadPhaseType::eMBP);
+					else
+						return false;
+				}
+			}
+			else if (arg == "--spawn")
+			{
+				options.OverlapFree.clear();
+				for (const auto& item : SplitList(value))
+				{
+					if (item == "uniform" || item == "overlap_free")
+						options.OverlapFree.push_back(item == "overlap_free");
+					else
+						return false;
+				}
+			}
+			else if (arg == "--collision-error")
+				options.CollisionError = std::max(std::stof(value), 0.0f);
+			else if (arg == "--steps")
+				options.Steps = std::max(std::stoi(value), 1);
+			else if (arg == "--settle")
+				options.SettleSteps = std::max(std::stoi(value), 0);
+			else if (arg == "--threads")
+				options.Threads = std::max(std::stoi(value), 0);
+			else if (arg == "--repeats")
+				options.Repeats = std::max(std::stoi(value), 1);
+			else if (arg == "--seed")
+				options.Seed = static_cast<unsigned int>(std::stoul(value));
+			else
+				return false;
+		}
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+	return !options.Counts.empty() && !options.CCD.empty() && !options.PCM.empty() &&
+		!options.Stabilization.empty() && !options.BroadPhases.empty() && !options.OverlapFree.empty();
+}
+
+//---------------------------------------
+// Bodies always request CCD, only valid if the scene has it enabled
+//---------------------------------------
+static void DisableCCD(PxScene* simulation)
+{
+	std::vector<PxActor*> dynamics(simulation->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC));
+	if (!dynamics.empty())
+	{
+		simulation->getActors(PxActorTypeFlag::eRIGID_DYNAMIC, dynamics.data(), static_cast<PxU32>(dynamics.size()));
+	}
+	for (auto currActor : dynamics)
+	{
+		static_cast<PxRigidDynamic*>(currActor)->setRigidBodyFlag(PxRigidBodyFlag::eENABLE_CCD, false);
+	}
+}
+
+//---------------------------------------
+// Entry point
+//---------------------------------------
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		std::cout << "Usage: PxBenchmark [--scene mesh] [--objects dir] [--counts 25,50,..] [--ccd on,off] [--pcm on,off]"
+			<< " [--stabilization on,off] [--broadphase abp,sap,mbp] [--spawn uniform,overlap_free]"
+			<< " [--collision-error 0] [--steps 2000] [--settle 20] [--threads 0]"
+			<< " [--repeats 1] [--seed 42]" << std::endl;
+		return -1;
+	}
+
+	if (!boost::filesystem::exists(options.ScenePath) || !boost::filesystem::is_directory(options.ObjectsPath))
+	{
+		std::cout << "Scene mesh " << options.ScenePath << " or objects folder " << options.ObjectsPath << " not found, exiting." << std::endl;
+		return -1;
+	}
+
+	// Physics only, always on the CPU
+	PxManager::GetInstance().InitPhysx(options.Threads);
+	PxSceneOptions sceneOptions;
+	sceneOptions.GPU = false;
+
+	// Scene & object meshes (cooked once, shared by all runs)
+	size_t baseMemory = ResidentBytes();
+	auto loadStart = std::chrono::steady_clock::now();
+	std::vector<PxMeshConvex*> prototypes;
+	{
+		std::vector<ModifiablePath> objectFiles;
+		for (const auto& entry : boost::filesystem::directory_iterator(options.ObjectsPath))
+		{
+			std::string ext = entry.path().extension().string();
+			if (ext == ".obj" || ext == ".ply" || ext == ".glb" || ext == ".gltf")
+				objectFiles.push_back(entry.path());
+		}
+		std::sort(objectFiles.begin(), objectFiles.end());
+		for (size_t i = 0; i < objectFiles.size(); ++i)
+		{
+			PxMeshConvex* pxCurr = new PxMeshConvex(objectFiles[i], "object", static_cast<int>(i));
+			pxCurr->SetObjId(0);
+			pxCurr->CreateMesh();
+			pxCurr->SetScale(PxVec3(1.0f));
+			prototypes.push_back(pxCurr);
+		}
+	}
+	if (prototypes.empty())
+	{
+		std::cout << "No object meshes in " << options.ObjectsPath << ", exiting." << std::endl;
+		PxManager::GetInstance().DeletePhysx();
+		return -1;
+	}
+	PxMeshTriangle* pxMeshScene = new PxMeshTriangle(options.ScenePath, "scene", 0);
+	pxMeshScene->SetSimplifyError(options.CollisionError);
+	pxMeshScene->CreateMesh();
+	pxMeshScene->SetObjId(0);
+	pxMeshScene->SetScale(PxVec3(1.0f));
+	float loadSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - loadStart).count();
+	std::cout << "\33[2K\r" << "Loaded " << prototypes.size() << " objects & scene in " << loadSeconds << "s ("
+		<< (static_cast<double>(ResidentBytes()) - static_cast<double>(baseMemory)) / (1024.0 * 1024.0) << " MB), "
+		<< PxManager::GetInstance().GetTaskPool()->GetWorkerCount() << " physx threads" << std::endl;
+
+	// One row per run
+	std::cout << "objects\tccd\tpcm\tstab\tbroadphase\tspawn\trejected\tunplaced\tsetup_s\tsteps\tsettled\tsim_s\tsteps_per_s\tsettle_s\ttasks\tmemory_mb\tpeak_mb" << std::endl;
+	const float timestep = 1.0f / 50.0f;
+	size_t peakMemory = ResidentBytes();
+	for (int count : options.Counts)
+	for (bool useCCD : options.CCD)
+	for (bool usePCM : options.PCM)
+	for (bool useStabilization : options.Stabilization)
+	for (auto broadPhase : options.BroadPhases)
+	for (bool overlapFree : options.OverlapFree)
+	for (int repeat = 0; repeat < options.Repeats; ++repeat)
+	{
+		sceneOptions.CCD = useCCD;
+		sceneOptions.PCM = usePCM;
+		sceneOptions.Stabilization = useStabilization;
+		sceneOptions.BroadPhase = broadPhase;
+		size_t startMemory = ResidentBytes();
+
+		// Same layout for every configuration
+		auto setupStart = std::chrono::steady_clock::now();
+		std::mt19937 generator(options.Seed + repeat);
+		PxScene* simulation = PxManager::GetInstance().CreateScene(pxMeshScene->GetGlobalBounds(), sceneOptions);
+		pxMeshScene->AddRigidActor(simulation, pxMeshScene->GetTransform());
+		PxSpawnOptions spawnOptions;
+		spawnOptions.OverlapFree = overlapFree;
+		PxSpawnStats spawnStats;
+		std::vector<PxMeshConvex> objects = PxSpawnObjects(generator, prototypes, *pxMeshScene, simulation, count,
+			spawnOptions, 1, spawnStats);
+		if (!useCCD)
+			DisableCCD(simulation);
+		float setupSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - setupStart).count();
+
+		// Run until settled or the step limit
+		PxSettleOptions settle;
+		settle.SettleSteps = options.SettleSteps;
+		auto simStart = std::chrono::steady_clock::now();
+		int steps = PxManager::RunSimulation(simulation, timestep, options.Steps, settle);
+		float simSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - simStart).count();
+		bool settled = steps < options.Steps;
+		size_t simMemory = ResidentBytes();
+		peakMemory = std::max(peakMemory, simMemory);
+
+		// Cleanup, dispatcher only after the scene
+		objects.clear();
+		simulation->flushSimulation();
+		auto dispatcher = static_cast<PxTaskPool::SceneDispatcher*>(simulation->getCpuDispatcher());
+		PX_RELEASE(simulation);
+		uint64_t tasks = dispatcher->GetTaskCount();
+		PX_RELEASE(dispatcher);
+
+		std::cout << count << "\t" << (useCCD ? "on" : "off") << "\t" << (usePCM ? "on" : "off") << "\t"
+			<< (useStabilization ? "on" : "off") << "\t" << BroadPhaseName(broadPhase) << "\t"
+			<< (overlapFree ? "overlap_free" : "uniform") << "\t" << spawnStats.RejectedSamples << "\t" << spawnStats.UnplacedObjects << "\t"
+			<< setupSeconds << "\t" << steps << "\t" << (settled ? "yes" : "no") << "\t"
+			<< simSeconds << "\t" << steps / std::max(simSeconds, 1e-6f) << "\t"
+			<< (settled ? std::to_string(steps * timestep) : std::string("-")) << "\t" << tasks << "\t"
+			<< (static_cast<double>(simMemory) - static_cast<double>(startMemory)) / (1024.0 * 1024.0) << "\t"
+			<< peakMemory / (1024.0 * 1024.0) << std::endl;
+	}
+
+	// Cleanup
+	delete pxMeshScene;
+	for (auto curr : prototypes)
+	{
+		delete curr;
+	}
+	PxManager::GetInstance().DeletePhysx();
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include <string>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <fstream>
+#include <iostream>
+
+#pragma warning(push, 0)
+#include <rapidjson/document.h>
+#include <rapidjson/istreamwrapper.h>
+
+#include <Helpers/RenderfileWriter.h>
+#pragma warning(pop)
+
+#ifndef RENDERFILE_BENCHMARK_DATA
+#define RENDERFILE_BENCHMARK_DATA "BlenderLib/python/BlenderModule/Test/module_test_base.json"
+#endif //RENDERFILE_BENCHMARK_DATA
+
+//---------------------------------------
+// Writes a parsed renderfile like the scene does
+//---------------------------------------
+static void Replay(
+	RenderfileWriter& writer,
+	const rapidjson::Value& value
+)
+{
+	if (value.IsObject())
+	{
+		writer.StartObject();
+		for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it)
+		{
+			writer.Key(it->name.GetString());
+			Replay(writer, it->value);
+		}
+		writer.EndObject();
+	}
+	else if (value.IsArray())
+	{
+		writer.StartArray();
+		for (auto it = value.Begin(); it != value.End(); ++it)
+		{
+			Replay(writer, *it);
+		}
+		writer.EndArray();
+	}
+	else if (value.IsString())
+		writer.String(value.GetString(), value.GetStringLength());
+	else if (value.IsBool())
+		writer.Bool(value.GetBool());
+	else if (value.IsInt())
+		writer.Int(value.GetInt());
+	else if (value.IsUint())
+		writer.Uint(value.GetUint());
+	else if (value.IsNumber())
+		writer.Double(value.GetDouble());
+}
+
+//---------------------------------------
+// Time to create & encode one renderfile
+//---------------------------------------
+static void BenchmarkWriter(
+	const std::string& format,
+	const rapidjson::Value& renderfile,
+	int count
+)
+{
+	size_t size = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < count; ++i)
+	{
+		std::unique_ptr<RenderfileWriter> writer(CreateRenderfileWriter(format));
+		Replay(*writer, renderfile);
+		size = writer->GetRenderfile().size();
+	}
+	double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << format << "\t" << size << " bytes\t" << elapsed / count << " ms" << std::endl;
+}
+
+//---------------------------------------
+// Entry point
+//---------------------------------------
+int main(int argc, char** argv)
+{
+	std::string path(argc > 1 ? argv[1] : RENDERFILE_BENCHMARK_DATA);
+	int count = 200, scale = 50;
+	try
+	{
+		count = argc > 2 ? std::max(std::stoi(argv[2]), 1) : count;
+		scale = argc > 3 ? std::max(std::stoi(argv[3]), 1) : scale;
+	}
+	catch (const std::exception&)
+	{
+		std::cout << "Usage: RenderfileBenchmark [renderfile.json] [count 200] [scale 50]" << std::endl;
+		return -1;
+	}
+
+	std::ifstream file(path);
+	rapidjson::IStreamWrapper wrapped(file);
+	rapidjson::Document renderfile;
+	renderfile.ParseStream(wrapped);
+	if (!file.is_open() || renderfile.HasParseError() || !renderfile.IsObject())
+	{
+		std::cout << "Renderfile " << path << " could not be read, exiting." << std::endl;
+		return -1;
+	}
+
+	// Enlarge scene to a realistic object count (same as RenderfileBenchmark.py)
+	if (renderfile.HasMember("meshes") && renderfile["meshes"].IsArray())
+	{
+		rapidjson::Value& meshes = renderfile["meshes"];
+		rapidjson::Value original(meshes, renderfile.GetAllocator());
+		for (int i = 1; i < scale; ++i)
+		{
+			for (auto it = original.Begin(); it != original.End(); ++it)
+			{
+				rapidjson::Value copy(*it, renderfile.GetAllocator());
+				meshes.PushBack(copy, renderfile.GetAllocator());
+			}
+		}
+	}
+
+	BenchmarkWriter("json", renderfile, count);
+	BenchmarkWriter("binary", renderfile, count);
+	return 0;
+}
@@ -0,0 +1,59 @@
+function(AddMeshOptimizer TO_TARGET INSTALL_PATH)
+    # For reusability
+    set(CONTENT_NAME meshoptimizer)
+    include(ContentHelpers)
+
+    # Check if package available
+    CheckMeshOptimizer(CHECK_FOUND)
+
+    # Load and build if not so
+    if(NOT ${CHECK_FOUND})
+        # Enable dependency download module
+        include(FetchContent)
+        # Download source code
+        FetchContent_Declare(${CONTENT_NAME}
+                            GIT_REPOSITORY https://github.com/zeux/meshoptimizer.git
+                            GIT_TAG v0.17
+                            GIT_SHALLOW True
+                            GIT_PROGRESS True
+        )
+        # Make available
+        FetchContent_GetProperties(${CONTENT_NAME})
+        if(NOT ${CONTENT_NAME}_POPULATED)
+            FetchContent_Populate(${CONTENT_NAME})
+            # Configure content (static library only)
+            CreateContent(${${CONTENT_NAME}_SOURCE_DIR} ${${CONTENT_NAME}_BINARY_DIR}
+                        CMAKE_INSTALL_PREFIX=${INSTALL_PATH}
+                        CMAKE_POSITION_INDEPENDENT_CODE=ON
+                        MESHOPT_BUILD_DEMO=OFF
+                        MESHOPT_BUILD_GLTFPACK=OFF
+                        MESHOPT_BUILD_SHARED_LIBS=OFF
+            )
+            # Build content
+            BuildContent(${${CONTENT_NAME}_BINARY_DIR} "release")
+            InstallContent(${${CONTENT_NAME}_BINARY_DIR} "release" ${INSTALL_PATH})
+
+            # Debug only on Windows
+            if(WIN32)
+                BuildContent(${${CONTENT_NAME}_BINARY_DIR} "debug")
+                InstallContent(${${CONTENT_NAME}_BINARY_DIR} "debug" ${INSTALL_PATH})
+            endif()
+        endif()
+        # Load package
+        CheckMeshOptimizer(CHECK_FOUND)
+    endif()
+
+    # Link and include library
+    target_link_libraries(${TO_TARGET} PRIVATE meshoptimizer::meshoptimizer)
+endfunction()
+
+function(CheckMeshOptimizer CHECK_FOUND)
+    # Try to load package
+    find_package(meshoptimizer
+                PATHS
+                ${INSTALL_PATH}
+                NO_DEFAULT_PATH
+    )
+    # Return result
+    set(CHECK_FOUND ${meshoptimizer_FOUND} PARENT_SCOPE)
+endfunction()
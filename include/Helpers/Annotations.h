@@ -6,6 +6,8 @@
 #include <Helpers/ImageProcessing.h>
 #include <Helpers/PathUtils.h>
 
+#include <Output/OutputSink.h>
+
 #include <Rendering/Settings.h>
 #include <Rendering/Camera.h>
 #include <Meshes/RenderMesh.h>
@@ -21,9 +23,11 @@ private:
 	// Fields
 	//---------------------------------------
 
-	boost::filesystem::ofstream osAnnotations;
+	std::ostringstream osAnnotations;
 	ModifiablePath basePath;
+	OutputSink& outputSink;
 	cv::Mat objectMask;
+	int currImage;
 
 	const char sep = ';';
 	const char end = '\n';
@@ -51,18 +55,13 @@ public:
 	//---------------------------------------
 
 	inline void Begin(
-		int currImage
+		int image
 	)
 	{
-		// Build path
-		ModifiablePath path(basePath);
-		path /= "labels_" + FormatInt(currImage) + ".csv";
-		// Make sure stream is ready
-		if (osAnnotations.is_open())
-			osAnnotations.close();
-		// Open or create file, clear existing
-		osAnnotations.open(path, std::ios_base::trunc);
-		// Add header
+		// Clear buffer & add header
+		currImage = image;
+		osAnnotations.str("");
+		osAnnotations.clear();
 		WriteHeader();
 	}
 
@@ -105,14 +104,17 @@ public:
 
 	inline void End()
 	{
-		// Properly close file
-		if (osAnnotations.good())
-		{
-			if (osAnnotations.is_open())
-			{
-				osAnnotations.close();
-			}
-		}
+		// Nothing to store
+		if (currImage < 0)
+			return;
+
+		// Build name
+		std::string name("labels_" + FormatInt(currImage) + ".csv");
+
+		// Hand to sink
+		outputSink.Store(currImage, basePath / name, osAnnotations.str());
+
+		currImage = -1;
 	}
 
 	//---------------------------------------
@@ -121,9 +123,12 @@ public:
 
 	AnnotationsManager(
 		ReferencePath storePath,
-		Eigen::Vector2i resolution
+		Eigen::Vector2i resolution,
+		OutputSink& sink
 	):
-		basePath(storePath)
+		basePath(storePath),
+		outputSink(sink),
+		currImage(-1)
 	{
 		// Create mask buffer
 		objectMask.create(resolution.y(), resolution.x(), CV_8UC1);
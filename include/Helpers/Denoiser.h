@@ -0,0 +1,130 @@
+#pragma once
+
+#include <mutex>
+#include <iostream>
+
+#pragma warning(push, 0)
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgproc.hpp>
+
+#if USE_OIDN
+#include <OpenImageDenoise/oidn.hpp>
+#endif //USE_OIDN
+#pragma warning(pop)
+
+//---------------------------------------
+// Denoises low sample renders on the CPU
+//---------------------------------------
+class Denoiser
+{
+private:
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	int threadCount;
+	std::mutex denoiseLock;
+#if USE_OIDN
+	oidn::DeviceRef device;
+#endif //USE_OIDN
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Continuous float image in [0, 1]
+	static cv::Mat X_ToFloat(
+		const cv::Mat& image,
+		float scale
+	)
+	{
+		cv::Mat converted;
+		image.convertTo(converted, CV_32FC3, scale);
+		return converted.isContinuous() ? converted : converted.clone();
+	}
+
+public:
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	inline int GetThreadCount() const { return threadCount; }
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Returns copy of 8 bit color image with the region denoised, albedo & normal are optional
+	cv::Mat Denoise(
+		const cv::Mat& color,
+		const cv::Mat& albedo,
+		const cv::Mat& normal,
+		const cv::Rect& region
+	)
+	{
+		cv::Rect image(0, 0, color.cols, color.rows);
+		cv::Rect area = region.area() > 0 ? region & image : image;
+		cv::Mat denoised = color.clone();
+		if (area.area() == 0)
+			return denoised;
+		cv::Mat colorArea = denoised(area);
+
+		// Own thread budget, independent of render processes
+		std::lock_guard<std::mutex> lock(denoiseLock);
+#if USE_OIDN
+		cv::Mat colorIn = X_ToFloat(colorArea, 1.0f / 255.0f);
+		cv::Mat colorOut(colorIn.size(), CV_32FC3);
+		oidn::FilterRef filter = device.newFilter("RT");
+		filter.setImage("color", colorIn.data, oidn::Format::Float3, area.width, area.height);
+		// Features only help if both are available
+		cv::Mat albedoIn, normalIn;
+		if (albedo.size() == color.size() && normal.size() == color.size())
+		{
+			albedoIn = X_ToFloat(albedo(area), 1.0f);
+			// Normals are stored in [0, 1]
+			normalIn = X_ToFloat(normal(area), 1.0f) * 2.0f - 1.0f;
+			filter.setImage("albedo", albedoIn.data, oidn::Format::Float3, area.width, area.height);
+			filter.setImage("normal", normalIn.data, oidn::Format::Float3, area.width, area.height);
+		}
+		filter.setImage("output", colorOut.data, oidn::Format::Float3, area.width, area.height);
+		filter.set("srgb", true);
+		filter.commit();
+		filter.execute();
+
+		const char* message;
+		if (device.getError(message) != oidn::Error::None)
+		{
+			std::cout << "Denoising failed: " << message << std::endl;
+			return denoised;
+		}
+		colorOut.convertTo(colorArea, CV_8UC3, 255.0f);
+#else
+		// Fallback is a plain bilateral blur, it ignores albedo & normal and only smooths noise below the color sigma
+		cv::Mat filtered;
+		cv::bilateralFilter(colorArea, filtered, 5, 30.0, 3.0);
+		filtered.copyTo(colorArea);
+#endif //USE_OIDN
+		return denoised;
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	Denoiser(
+		int threads
+	) :
+		threadCount(threads > 0 ? threads : 1),
+		denoiseLock()
+	{
+#if USE_OIDN
+		device = oidn::newDevice(oidn::DeviceType::CPU);
+		device.set("numThreads", threadCount);
+		device.commit();
+#endif //USE_OIDN
+	}
+
+	// No copy / move allowed
+	Denoiser(const Denoiser& copy) = delete;
+	Denoiser(Denoiser&& other) = delete;
+};
@@ -108,22 +108,107 @@ static cv::Mat ComputeRGBBlend(
 	const cv::Mat& bodiesRGB,
 	const cv::Mat& bodiesAO,
 	const cv::Mat& sceneRGB,
-	const cv::Mat& bodiesMask
+	const cv::Mat& bodiesMask,
+	const cv::Rect& region = cv::Rect()
 )
 {
-	cv::Mat blendResult;
-	// Add PBR object image to blend
-	bodiesRGB.copyTo(blendResult, bodiesMask);
+	// Only the region contains objects (whole image if empty)
+	cv::Rect image(0, 0, bodiesRGB.cols, bodiesRGB.rows);
+	cv::Rect area = region.area() > 0 ? region & image : image;
+	// Start with scene RGB image
+	cv::Mat blendResult = sceneRGB.clone();
+	cv::Mat bodiesArea;
+	bodiesRGB(area).copyTo(bodiesArea);
 	// Add ambient occlusion
-	blendResult.forEach<cv::Vec3b>([&](cv::Vec3b& val, const int pixel[]) -> void {
-		val *= bodiesAO.at<float>(pixel[0], pixel[1]);
+	cv::Mat aoArea = bodiesAO(area);
+	bodiesArea.forEach<cv::Vec3b>([&](cv::Vec3b& val, const int pixel[]) -> void {
+		val *= aoArea.at<float>(pixel[0], pixel[1]);
 	});
-	// Add scene RGB image to blend
-	sceneRGB.copyTo(blendResult, 255 - bodiesMask);
+	// Add PBR object image to blend
+	cv::Mat blendArea = blendResult(area);
+	bodiesArea.copyTo(blendArea, bodiesMask(area));
 	// Return blended image
 	return blendResult;
 }
 
+//---------------------------------------
+// Padded region covered by the mask
+//---------------------------------------
+static cv::Rect ComputeCropWindow(
+	const cv::Mat& mask,
+	int padding
+)
+{
+	// Empty if nothing is covered
+	cv::Rect covered = cv::boundingRect(mask);
+	if (covered.area() == 0)
+		return covered;
+	// Filter & AO need a few pixels around the objects
+	covered.x -= padding;
+	covered.y -= padding;
+	covered.width += 2 * padding;
+	covered.height += 2 * padding;
+	return covered & cv::Rect(0, 0, mask.cols, mask.rows);
+}
+
+//---------------------------------------
+// Joint bilateral upsampling of low resolution AO
+//---------------------------------------
+static cv::Mat ComputeAOUpsample(
+	const cv::Mat& lowAO,
+	const cv::Mat& depth,
+	const cv::Mat& labels,
+	const cv::Mat& mask,
+	int radius,
+	float depthSigma
+)
+{
+	// Plain interpolation where the filter finds no support
+	cv::Mat upsampled;
+	cv::resize(lowAO, upsampled, mask.size(), 0.0, 0.0, cv::INTER_LINEAR);
+	float scaleX = static_cast<float>(lowAO.cols) / static_cast<float>(mask.cols);
+	float scaleY = static_cast<float>(lowAO.rows) / static_cast<float>(mask.rows);
+	float spatialSigma = std::max(radius, 1) * 0.5f;
+
+	// Filter footprint covers several low resolution samples, which also removes noise
+	upsampled.forEach<float>([&](float& val, const int pixel[]) -> void {
+		// Only object pixels are blended
+		if (mask.at<uchar>(pixel[0], pixel[1]) == 0)
+			return;
+		float centerDepth = depth.at<float>(pixel[0], pixel[1]);
+		uchar centerLabel = labels.at<uchar>(pixel[0], pixel[1]);
+		float lowY = (pixel[0] + 0.5f) * scaleY - 0.5f;
+		float lowX = (pixel[1] + 0.5f) * scaleX - 0.5f;
+		int baseY = cvRound(lowY);
+		int baseX = cvRound(lowX);
+
+		float weightSum = 0.0f;
+		float aoSum = 0.0f;
+		for (int y = baseY - radius; y <= baseY + radius; ++y)
+		{
+			for (int x = baseX - radius; x <= baseX + radius; ++x)
+			{
+				if (y < 0 || x < 0 || y >= lowAO.rows || x >= lowAO.cols)
+					continue;
+				// Guides at the position of the sample, only the same object contributes
+				int guideY = std::min(static_cast<int>((y + 0.5f) / scaleY), mask.rows - 1);
+				int guideX = std::min(static_cast<int>((x + 0.5f) / scaleX), mask.cols - 1);
+				if (mask.at<uchar>(guideY, guideX) == 0 || labels.at<uchar>(guideY, guideX) != centerLabel)
+					continue;
+				float spatial = (y - lowY) * (y - lowY) + (x - lowX) * (x - lowX);
+				float relDepth = (depth.at<float>(guideY, guideX) - centerDepth) / centerDepth;
+				float weight = std::exp(-spatial / (2.0f * spatialSigma * spatialSigma) -
+					relDepth * relDepth / (2.0f * depthSigma * depthSigma));
+				weightSum += weight;
+				aoSum += weight * lowAO.at<float>(y, x);
+			}
+		}
+		if (weightSum > FLT_EPSILON)
+			val = aoSum / weightSum;
+	});
+	return upsampled;
+}
+
 //---------------------------------------
 // Creates label image from depth images
 //---------------------------------------
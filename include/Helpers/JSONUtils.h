@@ -8,15 +8,14 @@
 #include <rapidjson/stream.h>
 #include <rapidjson/document.h>
 #include <rapidjson/istreamwrapper.h>
-#include <rapidjson/prettywriter.h>
 
 #include <Helpers/PathUtils.h>
+#include <Helpers/RenderfileWriter.h>
 #pragma warning(pop)
 
 #define MOVE_DOC(doc) std::move(static_cast<rapidjson::Document&>(doc.Move()))
 
-typedef rapidjson::PrettyWriter<rapidjson::StringBuffer> JSONWriter;
-typedef rapidjson::PrettyWriter<rapidjson::StringBuffer>& JSONWriterRef;
+typedef RenderfileWriter& JSONWriterRef;
 
 //---------------------------------------
 // Fetch document from file to memory
@@ -56,7 +55,7 @@ static void AddString(
 	const std::string& toAdd
 )
 {
-	writer.String(toAdd.c_str(), static_cast<rapidjson::SizeType>(toAdd.length()));
+	writer.String(toAdd.c_str(), static_cast<unsigned int>(toAdd.length()));
 }
 
 //---------------------------------------
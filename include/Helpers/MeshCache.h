@@ -0,0 +1,262 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#pragma warning(push, 0)
+#include <boost/filesystem.hpp>
+#pragma warning(pop)
+
+// Bump whenever the layout or the imported data changes
+#define MESH_CACHE_VERSION 2
+// Sections start at cache line boundaries
+#define MESH_CACHE_ALIGNMENT 64
+// Source files are hashed in chunks of this size
+#define MESH_CACHE_CHUNK (1 << 20)
+
+//---------------------------------------
+// Versioned binary mesh, one file per source mesh
+//---------------------------------------
+class MeshCache
+{
+public:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Buffers of a mesh (float triples, float pairs & triangle indices)
+	struct MeshData
+	{
+		std::vector<float>& Vertices;
+		std::vector<int>& Indices;
+		std::vector<float>& Normals;
+		std::vector<float>& UVs;
+	};
+
+private:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Element count & byte offset of a section
+	struct Section
+	{
+		uint64_t Count;
+		uint64_t Offset;
+	};
+
+	// Fixed size, followed by the aligned sections
+	struct Header
+	{
+		char Magic[4];
+		uint32_t Version;
+		uint64_t Key;
+		Section Vertices;
+		Section Indices;
+		Section Normals;
+		Section UVs;
+	};
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	static inline uint64_t X_Align(
+		uint64_t offset
+	)
+	{
+		return (offset + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+	}
+
+	template<typename T>
+	static bool X_ReadSection(
+		std::ifstream& file,
+		uint64_t fileSize,
+		const Section& section,
+		std::vector<T>& out
+	)
+	{
+		// Corrupted offsets must not read past the file
+		if (section.Offset % MESH_CACHE_ALIGNMENT != 0 || section.Offset > fileSize ||
+			section.Count > (fileSize - section.Offset) / sizeof(T))
+			return false;
+		out.resize(static_cast<size_t>(section.Count));
+		file.seekg(static_cast<std::streamoff>(section.Offset));
+		file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(section.Count * sizeof(T)));
+		return static_cast<bool>(file);
+	}
+
+	// Cache files go to the configured directory (empty: next to the source)
+	static inline boost::filesystem::path& X_CacheDirectory()
+	{
+		static boost::filesystem::path directory;
+		return directory;
+	}
+
+	template<typename T>
+	static void X_WriteSection(
+		std::ofstream& file,
+		const Section& section,
+		const std::vector<T>& data
+	)
+	{
+		static const char padding[MESH_CACHE_ALIGNMENT] = {};
+		uint64_t position = static_cast<uint64_t>(file.tellp());
+		file.write(padding, static_cast<std::streamsize>(section.Offset - position));
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(T)));
+	}
+
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// FNV-1a, continued from hash
+	static uint64_t Hash(
+		uint64_t hash,
+		const void* data,
+		size_t size
+	)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// FNV-1a over 8 byte words, source files can be large
+	static bool HashFile(
+		const boost::filesystem::path& path,
+		uint64_t& hash
+	)
+	{
+		std::ifstream file(path.string(), std::ios::binary);
+		if (!file.is_open())
+			return false;
+		// Chunks are whole words, only the end of the file is hashed per byte
+		std::vector<char> chunk(MESH_CACHE_CHUNK);
+		while (file)
+		{
+			file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+			size_t readBytes = static_cast<size_t>(file.gcount());
+			size_t words = readBytes / sizeof(uint64_t);
+			for (size_t i = 0; i < words; ++i)
+			{
+				uint64_t word;
+				std::memcpy(&word, chunk.data() + i * sizeof(uint64_t), sizeof(word));
+				hash ^= word;
+				hash *= 1099511628211ull;
+			}
+			hash = Hash(hash, chunk.data() + words * sizeof(uint64_t), readBytes % sizeof(uint64_t));
+		}
+		return file.eof();
+	}
+
+	// Used for all following cache files, e.g. below cache_path
+	static void SetCacheDirectory(
+		const boost::filesystem::path& directory
+	)
+	{
+		X_CacheDirectory() = directory;
+	}
+
+	// Cache file of a source file, rewritten once the source changes
+	static boost::filesystem::path GetCachePath(
+		const boost::filesystem::path& source
+	)
+	{
+		const boost::filesystem::path& directory = X_CacheDirectory();
+		if (directory.empty())
+		{
+			boost::filesystem::path cachePath(source);
+			cachePath.concat(".mesh");
+			return cachePath;
+		}
+		// Sources with the same name in different folders need their own file
+		std::string sourcePath(boost::filesystem::absolute(source).string());
+		char hex[20];
+		std::snprintf(hex, sizeof(hex), ".%016llx", static_cast<unsigned long long>(
+			Hash(14695981039346656037ull, sourcePath.data(), sourcePath.size())));
+		boost::filesystem::path cachePath(directory / source.filename());
+		cachePath.concat(hex).concat(".mesh");
+		return cachePath;
+	}
+
+	// False if missing, stale or damaged
+	static bool Read(
+		const boost::filesystem::path& cachePath,
+		uint64_t key,
+		MeshData out
+	)
+	{
+		std::ifstream file(cachePath.string(), std::ios::binary);
+		if (!file.is_open())
+			return false;
+		file.seekg(0, std::ios::end);
+		uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+		file.seekg(0, std::ios::beg);
+		if (fileSize < sizeof(Header))
+			return false;
+
+		Header header;
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		if (!file || std::memcmp(header.Magic, "PRMC", 4) != 0 || header.Version != MESH_CACHE_VERSION || header.Key != key)
+			return false;
+
+		return X_ReadSection(file, fileSize, header.Vertices, out.Vertices) &&
+			X_ReadSection(file, fileSize, header.Indices, out.Indices) &&
+			X_ReadSection(file, fileSize, header.Normals, out.Normals) &&
+			X_ReadSection(file, fileSize, header.UVs, out.UVs);
+	}
+
+	// Written to a temporary file first, so readers never see partial caches, replaces stale caches
+	static void Write(
+		const boost::filesystem::path& cachePath,
+		uint64_t key,
+		MeshData data
+	)
+	{
+		Header header;
+		std::memcpy(header.Magic, "PRMC", 4);
+		header.Version = MESH_CACHE_VERSION;
+		header.Key = key;
+		header.Vertices = Section{ data.Vertices.size(), X_Align(sizeof(Header)) };
+		header.Indices = Section{ data.Indices.size(), X_Align(header.Vertices.Offset + data.Vertices.size() * sizeof(float)) };
+		header.Normals = Section{ data.Normals.size(), X_Align(header.Indices.Offset + data.Indices.size() * sizeof(int)) };
+		header.UVs = Section{ data.UVs.size(), X_Align(header.Normals.Offset + data.Normals.size() * sizeof(float)) };
+
+		boost::filesystem::path tempPath(cachePath);
+		tempPath.concat(".tmp");
+		bool written = false;
+		{
+			std::ofstream file(tempPath.string(), std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			X_WriteSection(file, header.Vertices, data.Vertices);
+			X_WriteSection(file, header.Indices, data.Indices);
+			X_WriteSection(file, header.Normals, data.Normals);
+			X_WriteSection(file, header.UVs, data.UVs);
+			written = static_cast<bool>(file);
+		}
+		boost::system::error_code error;
+		if (!written)
+		{
+			std::cout << "Could not write mesh cache: " << tempPath << std::endl;
+			boost::filesystem::remove(tempPath, error);
+			return;
+		}
+		boost::filesystem::rename(tempPath, cachePath, error);
+		if (error)
+		{
+			std::cout << "Could not write mesh cache: " << cachePath << " (" << error.message() << ")" << std::endl;
+			boost::filesystem::remove(tempPath, error);
+		}
+	}
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#pragma warning(push, 0)
+#include <meshoptimizer.h>
+#pragma warning(pop)
+
+//---------------------------------------
+// Quadric edge collapse until the surface moved by maxError (mesh units)
+//---------------------------------------
+static bool ComputeSimplifiedMesh(
+	std::vector<float>& vertices,
+	std::vector<int>& indices,
+	float maxError
+)
+{
+	size_t vertexCount = vertices.size() / 3;
+	if (maxError <= 0.0f || vertexCount == 0 || indices.size() < 3)
+		return false;
+
+	// Simplifier expects the error relative to the mesh extents
+	float meshScale = meshopt_simplifyScale(vertices.data(), vertexCount, sizeof(float) * 3);
+	if (meshScale <= 0.0f)
+		return false;
+
+	// No target count, only the error bound stops collapsing
+	std::vector<unsigned int> sourceIndices(indices.begin(), indices.end());
+	std::vector<unsigned int> simplifiedIndices(sourceIndices.size());
+	float resultError = 0.0f;
+	size_t indexCount = meshopt_simplify(simplifiedIndices.data(), sourceIndices.data(), sourceIndices.size(),
+		vertices.data(), vertexCount, sizeof(float) * 3, 0, maxError / meshScale, &resultError);
+	if (indexCount == 0 || indexCount == sourceIndices.size())
+		return false;
+	simplifiedIndices.resize(indexCount);
+
+	// Drop vertices no longer referenced
+	std::vector<float> simplifiedVertices(vertices.size());
+	size_t usedCount = meshopt_optimizeVertexFetch(simplifiedVertices.data(), simplifiedIndices.data(), indexCount,
+		vertices.data(), vertexCount, sizeof(float) * 3);
+	simplifiedVertices.resize(usedCount * 3);
+
+	vertices.swap(simplifiedVertices);
+	indices.assign(simplifiedIndices.begin(), simplifiedIndices.end());
+	return true;
+}
@@ -1,11 +1,40 @@
 #pragma once
 
+#include <thread>
+#include <vector>
+#include <algorithm>
+
 #pragma warning(push, 0)
 #include <PxPhysicsAPI.h>
+
+#include <Helpers/PxTaskPool.h>
+#include <Helpers/PxMeshRegistry.h>
 #pragma warning(pop)
 
 #define PX_RELEASE(x) if(x != NULL) { x->release(); x = NULL; }
 
+//---------------------------------------
+// Scene variations, defaults are used by the simulation
+//---------------------------------------
+struct PxSceneOptions
+{
+	bool GPU = true;
+	bool CCD = true;
+	bool PCM = true;
+	bool Stabilization = true;
+	physx::PxBroadPhaseType::Enum BroadPhase = physx::PxBroadPhaseType::eABP;
+};
+
+//---------------------------------------
+// Stop condition for simulations
+//---------------------------------------
+struct PxSettleOptions
+{
+	int SettleSteps = 0;
+	float SettleLinear = 0.01f;
+	float SettleAngular = 0.05f;
+};
+
 //---------------------------------------
 // Physx helper singleton
 //---------------------------------------
@@ -24,6 +53,8 @@ private:
 	physx::PxMaterial* pPxMaterial;
 	physx::PxFoundation* pPxFoundation;
 	physx::PxCudaContextManager* pPxCuda;
+	PxTaskPool* pPxTaskPool;
+	PxMeshRegistry* pPxMeshRegistry;
 	physx::PxDefaultAllocator pxAllocator;
 	physx::PxDefaultErrorCallback pxErrorCallback;
 
@@ -40,6 +71,8 @@ private:
 		pPxMaterial(NULL),
 		pPxFoundation(NULL),
 		pPxCuda(NULL),
+		pPxTaskPool(NULL),
+		pPxMeshRegistry(NULL),
 		pxAllocator(),
 		pxErrorCallback()
 	{
@@ -69,12 +102,14 @@ public:
 	inline const physx::PxCooking* GetCooker() { return pPxCooking; }
 	inline const physx::PxMaterial* GetMaterial() { return pPxMaterial; }
 	inline physx::PxCudaContextManager* GetCudaManager() { return pPxCuda; }
+	inline PxTaskPool* GetTaskPool() { return pPxTaskPool; }
+	inline PxMeshRegistry* GetMeshRegistry() { return pPxMeshRegistry; }
 
 	//---------------------------------------
 	// Methods
 	//---------------------------------------
 
-	inline void InitPhysx()
+	inline void InitPhysx(int threadCount)
 	{
 		using namespace physx;
 
@@ -117,6 +152,8 @@ public:
 		params.meshWeldTolerance = 0.01f;
 		params.buildGPUData = true;
 		pPxCooking = PxCreateCooking(PX_PHYSICS_VERSION, *pPxFoundation, params);
+		// Cooked meshes are shared by all users in the process
+		pPxMeshRegistry = new PxMeshRegistry(params);
 
 		// Enable extensions
 #if _DEBUG || DEBUG
@@ -127,6 +164,10 @@ public:
 
 		// Create default material
 		pPxMaterial = pPxPhysics->createMaterial(0.5f, 0.5f, 0.2f);
+
+		// One set of worker threads for all scenes (0: quarter of the cores)
+		int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+		pPxTaskPool = new PxTaskPool(threadCount > 0 ? threadCount : std::max(hardwareThreads / 4, 2));
 	}
 
 	inline static physx::PxFilterFlags CCDFilterShader(
@@ -139,6 +180,10 @@ public:
 		physx::PxU32 constantBlockSize
 	)
 	{
+		// Objects of different layouts never collide, the scene (group 0) collides with all
+		if (filterData0.word0 != 0 && filterData1.word0 != 0 && filterData0.word0 != filterData1.word0)
+			return physx::PxFilterFlag::eSUPPRESS;
+
 		// Enable continuous collision detection (CCD)
 		pairFlags = physx::PxPairFlag::eSOLVE_CONTACT;
 		pairFlags |= physx::PxPairFlag::eDETECT_CCD_CONTACT;
@@ -146,10 +191,143 @@ public:
 		return physx::PxFilterFlags();
 	}
 
+	// Same as the CCD shader, but only discrete contacts
+	inline static physx::PxFilterFlags DiscreteFilterShader(
+		physx::PxFilterObjectAttributes attributes0,
+		physx::PxFilterData filterData0,
+		physx::PxFilterObjectAttributes attributes1,
+		physx::PxFilterData filterData1,
+		physx::PxPairFlags& pairFlags,
+		const void* constantBlock,
+		physx::PxU32 constantBlockSize
+	)
+	{
+		physx::PxFilterFlags flags = CCDFilterShader(attributes0, filterData0, attributes1, filterData1,
+			pairFlags, constantBlock, constantBlockSize);
+		pairFlags.clear(physx::PxPairFlag::eDETECT_CCD_CONTACT);
+		return flags;
+	}
+
+	// Creates an empty scene on the shared task pool, GPU only if available
+	inline physx::PxScene* CreateScene(
+		const physx::PxBounds3& sanityBounds,
+		const PxSceneOptions& options
+	)
+	{
+		using namespace physx;
+
+		bool useGPU = options.GPU && pPxCuda;
+
+		// Standart gravity, continuous collision detection & GPU rigidbodies by default
+		PxSceneDesc sceneDesc(pPxPhysics->getTolerancesScale());
+		sceneDesc.broadPhaseType = useGPU ? PxBroadPhaseType::eGPU : options.BroadPhase;
+		sceneDesc.cpuDispatcher = pPxTaskPool->CreateSceneDispatcher();
+		sceneDesc.cudaContextManager = useGPU ? pPxCuda : NULL;
+		sceneDesc.filterShader = options.CCD ? CCDFilterShader : DiscreteFilterShader;
+		sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
+		sceneDesc.gpuMaxNumPartitions = 8;
+
+		sceneDesc.flags = PxSceneFlags();
+		if (useGPU)
+			sceneDesc.flags |= PxSceneFlag::eENABLE_GPU_DYNAMICS;
+		if (options.Stabilization)
+			sceneDesc.flags |= PxSceneFlag::eENABLE_STABILIZATION;
+		if (options.CCD)
+			sceneDesc.flags |= PxSceneFlag::eENABLE_CCD;
+		if (options.PCM)
+			sceneDesc.flags |= PxSceneFlag::eENABLE_PCM;
+
+		// Objects should never spawn outside the scene bounds
+		sceneDesc.sanityBounds = sanityBounds;
+
+		PxScene* scene = pPxPhysics->createScene(sceneDesc);
+
+		// Multi box pruning only works inside regions
+		if (scene && sceneDesc.broadPhaseType == PxBroadPhaseType::eMBP)
+		{
+			PxBounds3 regions[16];
+			PxU32 regionCount = PxBroadPhaseExt::createRegionsFromWorldBounds(regions, sanityBounds, 4);
+			for (PxU32 i = 0; i < regionCount; ++i)
+			{
+				PxBroadPhaseRegion region;
+				region.bounds = regions[i];
+				region.userData = NULL;
+				scene->addBroadPhaseRegion(region);
+			}
+		}
+		return scene;
+	}
+
+	// Simulates up to stepCount steps, earlier once everything settled, returns steps taken
+	inline static int RunSimulation(
+		physx::PxScene* scene,
+		float timestep,
+		int stepCount,
+		const PxSettleOptions& settle
+	)
+	{
+		using namespace physx;
+
+		// Objects that can come to rest
+		std::vector<PxActor*> dynamics(scene->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC));
+		if (!dynamics.empty())
+		{
+			scene->getActors(PxActorTypeFlag::eRIGID_DYNAMIC, dynamics.data(), static_cast<PxU32>(dynamics.size()));
+		}
+
+		// Simulate in steps, stop once nothing moves anymore (if enabled)
+		int steps = 0;
+		int calmSteps = 0;
+		while (steps < stepCount)
+		{
+			scene->simulate(timestep);
+			scene->fetchResults(true);
+			steps++;
+
+			if (settle.SettleSteps <= 0)
+				continue;
+
+			bool allSleeping = true;
+			bool allCalm = true;
+			for (auto currActor : dynamics)
+			{
+				PxRigidDynamic* body = static_cast<PxRigidDynamic*>(currActor);
+				if (body->isSleeping())
+					continue;
+				allSleeping = false;
+				if (body->getLinearVelocity().magnitude() > settle.SettleLinear ||
+					body->getAngularVelocity().magnitude() > settle.SettleAngular)
+				{
+					allCalm = false;
+					break;
+				}
+			}
+
+			calmSteps = allCalm ? calmSteps + 1 : 0;
+			if (allSleeping || calmSteps >= settle.SettleSteps)
+				break;
+		}
+		return steps;
+	}
+
 	inline void DeletePhysx()
 	{
 		using namespace physx;
 
+		// Scenes are released already, stop workers
+		if (pPxTaskPool)
+		{
+			delete pPxTaskPool;
+			pPxTaskPool = NULL;
+		}
+
+		// Meshes are released already, free leftovers
+		if (pPxMeshRegistry)
+		{
+			delete pPxMeshRegistry;
+			pPxMeshRegistry = NULL;
+		}
+
 		// Free physics
 		PX_RELEASE(pPxMaterial);
 		PxCloseExtensions();
@@ -0,0 +1,353 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <future>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <utility>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+
+#pragma warning(push, 0)
+#include <PxPhysicsAPI.h>
+
+#include <boost/filesystem.hpp>
+
+#include <Helpers/MeshCache.h>
+#pragma warning(pop)
+
+//---------------------------------------
+// Process wide, reference counted cooked meshes
+//---------------------------------------
+class PxMeshRegistry
+{
+public:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Cooks the mesh into the stream, false on error
+	typedef std::function<bool(physx::PxOutputStream&)> MeshCooker;
+
+private:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Cooked mesh & number of meshes using it
+	struct CookedMesh
+	{
+		std::shared_future<physx::PxBase*> Mesh;
+		int References;
+	};
+
+	typedef std::pair<std::string, uint64_t> MeshKey;
+
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	uint64_t paramsHash;
+	std::map<MeshKey, CookedMesh> cookedMeshes;
+	std::map<physx::PxBase*, MeshKey> meshKeys;
+	std::vector<std::future<void>> pendingWrites;
+	std::mutex registryLock;
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// FNV-1a, continued from hash
+	static uint64_t X_Hash(
+		uint64_t hash,
+		const void* data,
+		size_t size
+	)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// Changed source files or params never match an old cache
+	static boost::filesystem::path X_CachePath(
+		const MeshKey& key,
+		uint64_t sourceHash
+	)
+	{
+		char hex[20];
+		std::snprintf(hex, sizeof(hex), ".%016llx", static_cast<unsigned long long>(X_Hash(key.second, &sourceHash, sizeof(sourceHash))));
+		boost::filesystem::path cachePath(key.first);
+		cachePath.concat(hex).concat(".px");
+		return cachePath;
+	}
+
+	static bool X_ReadCache(
+		const boost::filesystem::path& cachePath,
+		std::vector<unsigned char>& out
+	)
+	{
+		std::ifstream file(cachePath.string(), std::ios::binary);
+		if (!file)
+			return false;
+		out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return !out.empty();
+	}
+
+	// Written to a temporary file first, so readers never see partial caches
+	static void X_WriteCache(
+		boost::filesystem::path cachePath,
+		std::vector<unsigned char> data
+	)
+	{
+		boost::filesystem::path tempPath(cachePath);
+		tempPath.concat(".tmp");
+		{
+			std::ofstream file(tempPath.string(), std::ios::binary | std::ios::trunc);
+			if (!file.write(reinterpret_cast<const char*>(data.data()), data.size()))
+			{
+				std::cout << "Could not write cooked mesh: " << tempPath << std::endl;
+				return;
+			}
+		}
+		boost::system::error_code error;
+		boost::filesystem::rename(tempPath, cachePath, error);
+		if (error)
+		{
+			std::cout << "Could not write cooked mesh: " << cachePath << " (" << error.message() << ")" << std::endl;
+			boost::filesystem::remove(tempPath, error);
+		}
+	}
+
+	// Loads from the disk cache or cooks into memory
+	physx::PxBase* X_Create(
+		const MeshKey& key,
+		const MeshCooker& cook,
+		const std::function<physx::PxBase*(physx::PxInputData&)>& create,
+		bool& cooked
+	)
+	{
+		using namespace physx;
+
+		// Unreadable sources are cooked without disk cache
+		uint64_t sourceHash = 14695981039346656037ull;
+		bool canCache = MeshCache::HashFile(key.first, sourceHash);
+		boost::filesystem::path cachePath = canCache ? X_CachePath(key, sourceHash) : boost::filesystem::path();
+
+		PxBase* mesh = NULL;
+		std::vector<unsigned char> data;
+		cooked = !canCache || !X_ReadCache(cachePath, data);
+		if (!cooked)
+		{
+			PxDefaultMemoryInputData readBuffer(data.data(), static_cast<PxU32>(data.size()));
+			mesh = create(readBuffer);
+			// Corrupt or incompatible cache, replaced by a fresh one
+			if (!mesh)
+			{
+				std::cout << "\33[2K\rInvalid cooked mesh, cooking again: " << cachePath << std::endl;
+				boost::system::error_code error;
+				boost::filesystem::remove(cachePath, error);
+				cooked = true;
+			}
+		}
+		if (cooked)
+		{
+			PxDefaultMemoryOutputStream cookBuffer;
+			if (!cook(cookBuffer))
+				return NULL;
+			data.assign(cookBuffer.getData(), cookBuffer.getData() + cookBuffer.getSize());
+			PxDefaultMemoryInputData readBuffer(data.data(), static_cast<PxU32>(data.size()));
+			mesh = create(readBuffer);
+		}
+
+		// Disk cache only speeds up the next run, nobody waits for it
+		if (mesh && cooked && canCache)
+		{
+			std::lock_guard<std::mutex> lock(registryLock);
+			pendingWrites.erase(std::remove_if(pendingWrites.begin(), pendingWrites.end(), [](const std::future<void>& write) {
+				return write.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+			}), pendingWrites.end());
+			pendingWrites.push_back(std::async(std::launch::async, &PxMeshRegistry::X_WriteCache, cachePath, std::move(data)));
+		}
+		return mesh;
+	}
+
+	physx::PxBase* X_Acquire(
+		const std::string& file,
+		uint64_t cookHash,
+		const MeshCooker& cook,
+		const std::function<physx::PxBase*(physx::PxInputData&)>& create,
+		bool& created
+	)
+	{
+		MeshKey key(file, X_Hash(paramsHash, &cookHash, sizeof(cookHash)));
+		std::promise<physx::PxBase*> cooking;
+		std::shared_future<physx::PxBase*> shared;
+		created = false;
+		{
+			std::lock_guard<std::mutex> lock(registryLock);
+			auto found = cookedMeshes.find(key);
+			if (found != cookedMeshes.end())
+			{
+				found->second.References++;
+				shared = found->second.Mesh;
+			}
+			else
+			{
+				cookedMeshes[key] = CookedMesh{ cooking.get_future().share(), 1 };
+			}
+		}
+		// Possibly still being cooked by another thread
+		if (shared.valid())
+		{
+			physx::PxBase* mesh = shared.get();
+			if (!mesh)
+			{
+				std::lock_guard<std::mutex> lock(registryLock);
+				auto found = cookedMeshes.find(key);
+				if (found != cookedMeshes.end() && --found->second.References == 0)
+					cookedMeshes.erase(found);
+			}
+			return mesh;
+		}
+
+		// Other meshes can be cooked in the meantime
+		bool cooked = false;
+		physx::PxBase* mesh = X_Create(key, cook, create, cooked);
+		created = mesh != NULL;
+		{
+			// Known before anyone waiting can release it
+			std::lock_guard<std::mutex> lock(registryLock);
+			if (mesh)
+			{
+				meshKeys[mesh] = key;
+			}
+			// Failed meshes are cooked again by the next caller
+			else if (--cookedMeshes[key].References == 0)
+			{
+				cookedMeshes.erase(key);
+			}
+		}
+		cooking.set_value(mesh);
+
+		std::cout << "\33[2K\r" << boost::filesystem::path(file).filename().string()
+			<< (mesh ? (cooked ? " cooked" : " loaded from cache") : " cooking failed") << std::flush;
+		return mesh;
+	}
+
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Shared convex mesh of the file, cooked only once per process
+	physx::PxConvexMesh* AcquireConvex(
+		const std::string& file,
+		uint64_t cookHash,
+		const MeshCooker& cook,
+		bool& created
+	)
+	{
+		physx::PxBase* mesh = X_Acquire(file, X_Hash(cookHash, "convex", 6), cook,
+			[](physx::PxInputData& data) -> physx::PxBase* { return PxGetPhysics().createConvexMesh(data); }, created);
+		return mesh ? mesh->is<physx::PxConvexMesh>() : NULL;
+	}
+
+	// Shared triangle mesh of the file, cooked only once per process
+	physx::PxTriangleMesh* AcquireTriangle(
+		const std::string& file,
+		uint64_t cookHash,
+		const MeshCooker& cook,
+		bool& created
+	)
+	{
+		physx::PxBase* mesh = X_Acquire(file, X_Hash(cookHash, "triangle", 8), cook,
+			[](physx::PxInputData& data) -> physx::PxBase* { return PxGetPhysics().createTriangleMesh(data); }, created);
+		return mesh ? mesh->is<physx::PxTriangleMesh>() : NULL;
+	}
+
+	// Another user of an acquired mesh (copies)
+	void AddReference(
+		physx::PxBase* mesh
+	)
+	{
+		if (!mesh)
+			return;
+		std::lock_guard<std::mutex> lock(registryLock);
+		auto key = meshKeys.find(mesh);
+		if (key != meshKeys.end())
+			cookedMeshes[key->second].References++;
+	}
+
+	// Released once the last user is gone
+	void Release(
+		physx::PxBase* mesh
+	)
+	{
+		if (!mesh)
+			return;
+		std::lock_guard<std::mutex> lock(registryLock);
+		auto key = meshKeys.find(mesh);
+		if (key == meshKeys.end())
+			return;
+		auto cookedMesh = cookedMeshes.find(key->second);
+		if (--cookedMesh->second.References > 0)
+			return;
+		cookedMeshes.erase(cookedMesh);
+		meshKeys.erase(key);
+		mesh->release();
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	// Meshes cooked with different params are never shared
+	PxMeshRegistry(
+		const physx::PxCookingParams& params
+	) :
+		paramsHash(14695981039346656037ull),
+		cookedMeshes(),
+		meshKeys(),
+		pendingWrites(),
+		registryLock()
+	{
+		uint32_t version = PX_PHYSICS_VERSION;
+		uint32_t preprocess = static_cast<uint32_t>(params.meshPreprocessParams);
+		uint32_t midphase = static_cast<uint32_t>(params.midphaseDesc.getType());
+		paramsHash = X_Hash(paramsHash, &version, sizeof(version));
+		paramsHash = X_Hash(paramsHash, &preprocess, sizeof(preprocess));
+		paramsHash = X_Hash(paramsHash, &midphase, sizeof(midphase));
+		paramsHash = X_Hash(paramsHash, &params.meshWeldTolerance, sizeof(params.meshWeldTolerance));
+		paramsHash = X_Hash(paramsHash, &params.buildGPUData, sizeof(params.buildGPUData));
+		paramsHash = X_Hash(paramsHash, &params.convexMeshCookingType, sizeof(params.convexMeshCookingType));
+	}
+
+	// Remaining meshes are released, disk caches finished
+	~PxMeshRegistry()
+	{
+		for (auto& write : pendingWrites)
+		{
+			write.wait();
+		}
+		for (auto& key : meshKeys)
+		{
+			key.first->release();
+		}
+	}
+
+	// No copy / move allowed
+	PxMeshRegistry(const PxMeshRegistry& copy) = delete;
+	PxMeshRegistry(PxMeshRegistry&& other) = delete;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vector>
+#include <random>
+#include <utility>
+
+#pragma warning(push, 0)
+#include <PxPhysicsAPI.h>
+
+#include <Meshes/PxMeshConvex.h>
+#include <Meshes/PxMeshTriangle.h>
+#pragma warning(pop)
+
+//---------------------------------------
+// Spawn volume (relative to the scene extends) & forces
+//---------------------------------------
+struct PxSpawnOptions
+{
+	physx::PxVec3 SpawnMin = physx::PxVec3(-0.75f, 0.25f, -0.75f);
+	physx::PxVec3 SpawnMax = physx::PxVec3(0.75f, 0.75f, 0.75f);
+	physx::PxVec3 VelocityMax = physx::PxVec3(0.0f);
+	physx::PxVec3 TorqueMax = physx::PxVec3(0.0f);
+	float ApplyProbability = 0.0f;
+	bool OverlapFree = false;
+	int SpawnAttempts = 30;
+};
+
+//---------------------------------------
+// Samples rejected while spawning
+//---------------------------------------
+struct PxSpawnStats
+{
+	int RejectedSamples = 0;
+	int UnplacedObjects = 0;
+};
+
+//---------------------------------------
+// Places random instances of the prototypes in the scene, same layout for the same generator state
+//---------------------------------------
+template<typename Generator>
+std::vector<PxMeshConvex> PxSpawnObjects(
+	Generator& generator,
+	const std::vector<PxMeshConvex*>& prototypes,
+	PxMeshTriangle& sceneMesh,
+	physx::PxScene* simulation,
+	int count,
+	const PxSpawnOptions& options,
+	physx::PxU32 collisionGroup,
+	PxSpawnStats& stats
+)
+{
+	using namespace physx;
+
+	// Helper lambdas
+	auto uniformRandInt = [&](int lower, int upper) -> int
+	{
+		std::uniform_int_distribution<int> distr(lower, upper);
+		return distr(generator);
+	};
+	auto uniformRandVec = [&](PxVec3 lower, PxVec3 upper) -> PxVec3
+	{
+		std::uniform_real_distribution<float> distX(lower.x, upper.x);
+		std::uniform_real_distribution<float> distY(lower.y, upper.y);
+		std::uniform_real_distribution<float> distZ(lower.z, upper.z);
+		return PxVec3(distX(generator), distY(generator), distZ(generator));
+	};
+	auto applyForce = [&](float likelyhood) -> bool
+	{
+		std::bernoulli_distribution distr(likelyhood);
+		return distr(generator);
+	};
+
+	// Simulation objects
+	std::vector<PxMeshConvex> newBodies;
+	newBodies.reserve(count);
+	stats = PxSpawnStats();
+
+	// Setup & fetch params
+	const PxVec3 sceneCenter = sceneMesh.GetGlobalBounds().getCenter();
+	const PxVec3 sceneExtends = sceneMesh.GetGlobalBounds().getExtents();
+
+	// Overlap free: samples are retried until they are free
+	const int spawnAttempts = options.OverlapFree ? options.SpawnAttempts : 1;
+	std::vector<std::pair<PxVec3, float>> spawnedSpheres;
+
+	// Checks bounding spheres of this layout (poisson disk) & the cooked scene geometry
+	auto isFree = [&](const PxMeshConvex& obj, const PxVec3& pos, const PxVec3& sphereCenter, float sphereRadius) -> bool
+	{
+		for (const auto& other : spawnedSpheres)
+		{
+			float minDist = other.second + sphereRadius;
+			if ((other.first - sphereCenter).magnitudeSquared() < minDist * minDist)
+				return false;
+		}
+		// Only static actors, objects of other layouts never collide anyway
+		PxOverlapBuffer hit;
+		return !simulation->overlap(obj.GetGeometry(), PxTransform(pos, PxQuat(PxIdentity)), hit,
+			PxQueryFilterData(PxQueryFlag::eSTATIC | PxQueryFlag::eANY_HIT));
+	};
+
+	// For each object
+	for (int i = 0; i < count; ++i)
+	{
+		// Fetch random object & create instance with new id
+		int randObj = uniformRandInt(0, static_cast<int>(prototypes.size()) - 1);
+		PxMeshConvex currObj(*prototypes[randObj]);
+		currObj.SetObjId(i + 1);
+		currObj.CreateMesh();
+
+		// Not placed yet, so the bounds are still local
+		const PxVec3 sphereOffset = currObj.GetGlobalBounds().getCenter();
+		const float sphereRadius = currObj.GetGlobalBounds().getExtents().magnitude();
+
+		// Random position in scene, the last sample is used if none was free
+		PxVec3 randPos;
+		bool placed = false;
+		for (int attempt = 0; attempt < spawnAttempts && !placed; ++attempt)
+		{
+			randPos = sceneCenter +
+				uniformRandVec(options.SpawnMin, options.SpawnMax).multiply(sceneExtends);
+			placed = !options.OverlapFree || isFree(currObj, randPos, randPos + sphereOffset, sphereRadius);
+			stats.RejectedSamples += placed ? 0 : 1;
+		}
+		stats.UnplacedObjects += placed ? 0 : 1;
+		if (options.OverlapFree)
+		{
+			spawnedSpheres.push_back(std::make_pair(randPos + sphereOffset, sphereRadius));
+		}
+
+		// Set pose & actor
+		PxTransform pose(randPos, PxQuat(PxIdentity));
+		currObj.AddRigidActor(simulation, pose, collisionGroup);
+
+		// Possibly add random velocity & torque impulses
+		if (applyForce(options.ApplyProbability))
+		{
+			currObj.AddVelocity(uniformRandVec(-options.VelocityMax, options.VelocityMax));
+			currObj.AddTorque(uniformRandVec(-options.TorqueMax, options.TorqueMax));
+		}
+
+		// Place in vector
+		newBodies.push_back(std::move(currObj));
+	}
+
+	// Return simulation objects
+	return newBodies;
+}
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <condition_variable>
+
+#pragma warning(push, 0)
+#include <PxPhysicsAPI.h>
+#pragma warning(pop)
+
+//---------------------------------------
+// Work stealing pool shared by all physx scenes
+//---------------------------------------
+class PxTaskPool
+{
+public:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Tasks run for one scene
+	struct SceneStats
+	{
+		std::atomic<uint64_t> Tasks;
+		std::atomic<uint64_t> Nanoseconds;
+	};
+
+	// Dispatcher handed to a scene, forwards to the pool
+	class SceneDispatcher : public physx::PxCpuDispatcher
+	{
+	private:
+		//---------------------------------------
+		// Fields
+		//---------------------------------------
+
+		PxTaskPool& taskPool;
+		SceneStats sceneStats;
+
+	public:
+		//---------------------------------------
+		// Properties
+		//---------------------------------------
+
+		inline uint64_t GetTaskCount() const { return sceneStats.Tasks; }
+		inline float GetTaskSeconds() const { return static_cast<float>(sceneStats.Nanoseconds) * 1e-9f; }
+
+		//---------------------------------------
+		// Methods
+		//---------------------------------------
+
+		virtual void submitTask(physx::PxBaseTask& task) override { taskPool.X_Submit(task, &sceneStats); }
+		virtual uint32_t getWorkerCount() const override { return taskPool.GetWorkerCount(); }
+
+		// Same interface as physx objects (PX_RELEASE)
+		inline void release() { delete this; }
+
+		//---------------------------------------
+		// Constructors
+		//---------------------------------------
+
+		SceneDispatcher(
+			PxTaskPool& pool
+		) :
+			taskPool(pool),
+			sceneStats()
+		{
+			sceneStats.Tasks = 0;
+			sceneStats.Nanoseconds = 0;
+		}
+
+		virtual ~SceneDispatcher()
+		{
+		}
+
+		// No copy / move allowed
+		SceneDispatcher(const SceneDispatcher& copy) = delete;
+		SceneDispatcher(SceneDispatcher&& other) = delete;
+	};
+
+private:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	struct PoolTask
+	{
+		physx::PxBaseTask* Task;
+		SceneStats* Stats;
+	};
+
+	// Owner pops newest, thieves take oldest
+	struct WorkerQueue
+	{
+		std::deque<PoolTask> Tasks;
+		std::mutex Lock;
+	};
+
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	std::vector<std::unique_ptr<WorkerQueue>> workerQueues;
+	std::vector<std::thread> workerThreads;
+	std::atomic<uint32_t> nextQueue;
+	// Guarded by sleepLock, briefly negative if a task is taken before it was counted
+	std::ptrdiff_t pendingTasks;
+	std::mutex sleepLock;
+	std::condition_variable workAvailable;
+	bool isClosing;
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Pool & queue of the calling thread (NULL if not a worker)
+	static inline std::pair<PxTaskPool*, int>& X_CurrentWorker()
+	{
+		static thread_local std::pair<PxTaskPool*, int> current(NULL, -1);
+		return current;
+	}
+
+	void X_Submit(
+		physx::PxBaseTask& task,
+		SceneStats* stats
+	)
+	{
+		// Tasks spawned by a worker stay on its queue
+		std::pair<PxTaskPool*, int>& current = X_CurrentWorker();
+		int queue = current.first == this ? current.second :
+			static_cast<int>(nextQueue++ % static_cast<uint32_t>(workerQueues.size()));
+		{
+			std::lock_guard<std::mutex> lock(workerQueues[queue]->Lock);
+			workerQueues[queue]->Tasks.push_back(PoolTask{ &task, stats });
+		}
+		// Counted under the sleep lock, so no worker misses it
+		{
+			std::lock_guard<std::mutex> lock(sleepLock);
+			pendingTasks++;
+		}
+		workAvailable.notify_one();
+	}
+
+	bool X_Take(
+		int queue,
+		bool steal,
+		PoolTask& out
+	)
+	{
+		{
+			std::lock_guard<std::mutex> lock(workerQueues[queue]->Lock);
+			std::deque<PoolTask>& tasks = workerQueues[queue]->Tasks;
+			if (tasks.empty())
+				return false;
+			if (steal)
+			{
+				out = tasks.front();
+				tasks.pop_front();
+			}
+			else
+			{
+				out = tasks.back();
+				tasks.pop_back();
+			}
+		}
+		// Same lock as submitting & sleeping, so the count never goes stale
+		std::lock_guard<std::mutex> lock(sleepLock);
+		pendingTasks--;
+		return true;
+	}
+
+	bool X_Next(
+		int queue,
+		PoolTask& out
+	)
+	{
+		if (X_Take(queue, false, out))
+			return true;
+		// Own queue is empty, steal from the others
+		int queueCount = static_cast<int>(workerQueues.size());
+		for (int offset = 1; offset < queueCount; ++offset)
+		{
+			if (X_Take((queue + offset) % queueCount, true, out))
+				return true;
+		}
+		return false;
+	}
+
+	void X_WorkerLoop(
+		int queue
+	)
+	{
+		X_CurrentWorker() = std::make_pair(this, queue);
+		while (true)
+		{
+			PoolTask next;
+			if (X_Next(queue, next))
+			{
+				auto start = std::chrono::steady_clock::now();
+				next.Task->run();
+				auto taken = std::chrono::steady_clock::now() - start;
+				// Counted before releasing, the scene may be gone afterwards
+				next.Stats->Tasks++;
+				next.Stats->Nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(taken).count();
+				next.Task->release();
+				continue;
+			}
+
+			// Sleep until something is submitted
+			std::unique_lock<std::mutex> lock(sleepLock);
+			workAvailable.wait(lock, [&] { return isClosing || pendingTasks > 0; });
+			if (isClosing && pendingTasks == 0)
+				break;
+		}
+	}
+
+public:
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	inline uint32_t GetWorkerCount() const { return static_cast<uint32_t>(workerThreads.size()); }
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Released with PX_RELEASE after the scene
+	inline SceneDispatcher* CreateSceneDispatcher() { return new SceneDispatcher(*this); }
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	PxTaskPool(
+		int threadCount
+	) :
+		workerQueues(),
+		workerThreads(),
+		nextQueue(0),
+		pendingTasks(0),
+		sleepLock(),
+		workAvailable(),
+		isClosing(false)
+	{
+		int workers = threadCount > 0 ? threadCount : 1;
+		for (int i = 0; i < workers; ++i)
+		{
+			workerQueues.emplace_back(new WorkerQueue());
+		}
+		for (int i = 0; i < workers; ++i)
+		{
+			workerThreads.emplace_back(&PxTaskPool::X_WorkerLoop, this, i);
+		}
+	}
+
+	~PxTaskPool()
+	{
+		// Remaining tasks are still run
+		{
+			std::lock_guard<std::mutex> lock(sleepLock);
+			isClosing = true;
+		}
+		workAvailable.notify_all();
+		for (auto& worker : workerThreads)
+		{
+			worker.join();
+		}
+	}
+
+	// No copy / move allowed
+	PxTaskPool(const PxTaskPool& copy) = delete;
+	PxTaskPool(PxTaskPool&& other) = delete;
+};
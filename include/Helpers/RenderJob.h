@@ -0,0 +1,179 @@
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <functional>
+
+#pragma warning(push, 0)
+#include <Helpers/RenderfileTracker.h>
+#include <Helpers/RenderfileWriter.h>
+#include <Helpers/RenderPool.h>
+
+#include <Rendering/Camera.h>
+#include <Rendering/Texture.h>
+
+#include <Renderfile.h>
+#pragma warning(pop)
+
+// Failed renders repeated before giving up
+#define MAX_RENDER_RETRIES 2
+
+// Builds a renderfile for the cameras & places one output per camera
+typedef std::function<void(JSONWriterRef, RenderfileTracker&, std::vector<Camera>&, std::vector<Texture>&)> RenderBuilder;
+
+//---------------------------------------
+// Submitted renderfile, rebuilt if necessary
+//---------------------------------------
+class RenderJob
+{
+private:
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	RenderPool& renderPool;
+	int producerID;
+	int workerID;
+	std::string renderPass;
+	std::vector<Camera>& renderCams;
+	std::vector<Texture>& renderResults;
+	size_t submittedCams;
+	float renderTimeout;
+	RenderBuilder builder;
+	Blender::RenderFuture renderFuture;
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	void X_Submit(
+		std::vector<Camera>& cams,
+		std::vector<Texture>& results,
+		bool removeStale
+	)
+	{
+		renderTimeout = renderPool.GetTimeModel().GetTimeout(renderPass, cams.size());
+		workerID = renderPool.SelectWorker(producerID, renderTimeout);
+		// Build & submit atomically, so the process receives renderfiles in tracking order
+		std::lock_guard<std::mutex> lock(renderPool.GetLock(workerID));
+		RenderfileTracker& tracker = renderPool.GetTracker(workerID);
+		std::unique_ptr<RenderfileWriter> writer(CreateRenderfileWriter(renderPool.GetFormat()));
+		builder(*writer, tracker, cams, results);
+		// Outputs of earlier runs would count as rendered on retry
+		if (removeStale)
+		{
+			for (auto& currResult : results)
+			{
+				if (currResult.GetTexture().empty())
+					boost::filesystem::remove(currResult.GetPath());
+			}
+		}
+		std::string renderfile = writer->GetRenderfile();
+		// Builders skip cameras with existing outputs, empty renderfiles are not rendered at all
+		submittedCams = renderfile.empty() ? 0 : tracker.GetWritten("cameras");
+		if (submittedCams > 0)
+			renderTimeout = renderPool.GetTimeModel().GetTimeout(renderPass, submittedCams);
+		if (!renderfile.empty())
+			renderPool.AddRenderfileBytes(renderPass, renderfile.size(), tracker.GetSkippedBytes());
+		renderFuture = renderPool.GetRenderer()->SubmitRenderfile(renderfile, renderTimeout, workerID, tracker.WasDelta());
+	}
+
+	// Only cameras without output are rendered again, false if none
+	bool X_SubmitMissing()
+	{
+		std::vector<Camera> missingCams;
+		for (size_t curr = 0; curr < renderResults.size(); ++curr)
+		{
+			if (!renderResults[curr].TextureExists())
+				missingCams.push_back(renderCams[curr]);
+		}
+		if (missingCams.empty())
+			return false;
+
+		// Outputs have the same paths, results stay valid
+		std::vector<Texture> retryResults;
+		X_Submit(missingCams, retryResults, false);
+		return true;
+	}
+
+public:
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	inline Blender::RenderFuture& GetFuture() { return renderFuture; }
+	inline int GetWorker() const { return workerID; }
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Blocks until rendered, resubmits missing cameras if rejected or failed
+	bool Wait()
+	{
+		int retries = 0;
+		while (!renderFuture.Wait())
+		{
+			if (renderFuture.IsCancelled())
+				return false;
+
+			if (renderFuture.HasFailed())
+			{
+				renderPool.AddWasted(renderFuture.GetRenderTime());
+				if (++retries > MAX_RENDER_RETRIES)
+				{
+					std::cout << "Giving up on " << renderPass << " render after " << MAX_RENDER_RETRIES << " retries" << std::endl;
+					return false;
+				}
+			}
+
+			// Process lost its scene, send everything again
+			{
+				std::lock_guard<std::mutex> lock(renderPool.GetLock(workerID));
+				renderPool.GetTracker(workerID).Reset();
+			}
+			if (!X_SubmitMissing())
+				return true;
+		}
+
+		// Nothing was rendered if all cameras were skipped
+		if (submittedCams > 0)
+			renderPool.GetTimeModel().AddSample(renderPass, renderFuture.GetRenderTime(), submittedCams);
+		return true;
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	// Builder is called once with all cameras, afterwards with copies of the missing ones
+	RenderJob(
+		RenderPool& pool,
+		int producer,
+		const std::string& pass,
+		std::vector<Camera>& cams,
+		std::vector<Texture>& results,
+		const RenderBuilder& builder
+	) :
+		renderPool(pool),
+		producerID(producer),
+		workerID(0),
+		renderPass(pass),
+		renderCams(cams),
+		renderResults(results),
+		submittedCams(0),
+		renderTimeout(0.0f),
+		builder(builder),
+		renderFuture()
+	{
+		renderResults.clear();
+		X_Submit(renderCams, renderResults, true);
+	}
+
+	// No copy / move allowed
+	RenderJob(const RenderJob& copy) = delete;
+	RenderJob(RenderJob&& other) = delete;
+};
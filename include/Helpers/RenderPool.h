@@ -0,0 +1,186 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#pragma warning(push, 0)
+#include <BlenderLib/BlenderRenderer.h>
+
+#include <Helpers/RenderfileTracker.h>
+#include <Helpers/RenderTimeModel.h>
+#pragma warning(pop)
+
+//---------------------------------------
+// Render processes shared by all scene threads
+//---------------------------------------
+class RenderPool
+{
+private:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Bytes sent per pass & the bytes complete renderfiles would have had
+	struct RenderfileBytes
+	{
+		size_t Sent;
+		size_t Complete;
+	};
+
+	// Scene held by one process, changed by one thread at a time
+	struct WorkerState
+	{
+		RenderfileTracker Tracker;
+		std::mutex Lock;
+
+		WorkerState(bool deltaEnabled, const std::string& format) :
+			Tracker(deltaEnabled, format),
+			Lock()
+		{
+		}
+	};
+
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	Blender::BlenderRenderer* pRenderer;
+	std::string renderFormat;
+	std::vector<std::unique_ptr<WorkerState>> workerStates;
+	std::map<int, int> lastWorkers;
+	std::mutex affinityLock;
+	RenderTimeModel timeModel;
+	float wastedSeconds;
+	std::mutex wastedLock;
+	bool isDelta;
+	std::map<std::string, RenderfileBytes> passBytes;
+	std::mutex bytesLock;
+
+public:
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	inline Blender::BlenderRenderer* GetRenderer() const { return pRenderer; }
+	inline const std::string& GetFormat() const { return renderFormat; }
+	inline RenderfileTracker& GetTracker(int worker) { return workerStates[worker]->Tracker; }
+	inline std::mutex& GetLock(int worker) { return workerStates[worker]->Lock; }
+	inline RenderTimeModel& GetTimeModel() { return timeModel; }
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Process for the next render of a thread, reuses its last one if not too busy
+	int SelectWorker(
+		int producer,
+		float cost
+	)
+	{
+		std::lock_guard<std::mutex> lock(affinityLock);
+		auto found = lastWorkers.find(producer);
+		int worker = pRenderer->SelectWorker(found != lastWorkers.end() ? found->second : producer, cost);
+		lastWorkers[producer] = worker;
+		return worker;
+	}
+
+	// Render time lost to timeouts & crashes
+	void AddWasted(
+		float seconds
+	)
+	{
+		std::lock_guard<std::mutex> lock(wastedLock);
+		wastedSeconds += seconds;
+	}
+
+	float PopWasted()
+	{
+		std::lock_guard<std::mutex> lock(wastedLock);
+		float wasted = wastedSeconds;
+		wastedSeconds = 0.0f;
+		return wasted;
+	}
+
+	// Renderfile sizes, skipped data was left out by the delta
+	void AddRenderfileBytes(
+		const std::string& pass,
+		size_t sent,
+		size_t skipped
+	)
+	{
+		std::lock_guard<std::mutex> lock(bytesLock);
+		RenderfileBytes& bytes = passBytes[pass];
+		bytes.Sent += sent;
+		bytes.Complete += sent + skipped;
+	}
+
+	// Prints & clears renderfile sizes per pass
+	void PrintRenderfileBytes()
+	{
+		std::lock_guard<std::mutex> lock(bytesLock);
+		if (!isDelta)
+			return;
+		std::cout << "Renderfile bytes per pass (sent / complete):" << std::endl;
+		for (const auto& currPass : passBytes)
+		{
+			const RenderfileBytes& bytes = currPass.second;
+			std::cout << "\t" << currPass.first << ":\t" << bytes.Sent << " / " << bytes.Complete << " ("
+				<< (bytes.Complete > 0 ? 100 * (bytes.Complete - bytes.Sent) / bytes.Complete : 0) << "% saved)" << std::endl;
+		}
+		passBytes.clear();
+	}
+
+	// Clears scenes of all processes, only call while idle
+	void ResetAll()
+	{
+		// Resets run on the dispatchers, after pending prewarms
+		std::vector<Blender::RenderFuture> resets;
+		for (int i = 0; i < static_cast<int>(workerStates.size()); ++i)
+		{
+			resets.push_back(pRenderer->ResetProcess(i));
+		}
+		for (int i = 0; i < static_cast<int>(workerStates.size()); ++i)
+		{
+			resets[i].Wait();
+			std::lock_guard<std::mutex> lock(workerStates[i]->Lock);
+			workerStates[i]->Tracker.Reset();
+		}
+		std::lock_guard<std::mutex> lock(affinityLock);
+		lastWorkers.clear();
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	RenderPool(
+		Blender::BlenderRenderer* renderer,
+		const std::string& format,
+		bool deltaEnabled
+	) :
+		pRenderer(renderer),
+		renderFormat(format),
+		workerStates(),
+		lastWorkers(),
+		affinityLock(),
+		timeModel(),
+		wastedSeconds(0.0f),
+		wastedLock(),
+		isDelta(deltaEnabled),
+		passBytes(),
+		bytesLock()
+	{
+		for (int i = 0; i < pRenderer->GetWorkerCount(); ++i)
+		{
+			workerStates.emplace_back(new WorkerState(deltaEnabled, format));
+		}
+	}
+
+	// No copy / move allowed
+	RenderPool(const RenderPool& copy) = delete;
+	RenderPool(RenderPool&& other) = delete;
+};
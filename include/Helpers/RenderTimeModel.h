@@ -0,0 +1,99 @@
+#pragma once
+
+#include <map>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <algorithm>
+
+#pragma warning(push, 0)
+#include <Renderfile.h>
+#pragma warning(pop)
+
+// Samples until measured timeouts are trusted
+#define RENDER_TIMEOUT_SAMPLES 3
+
+//---------------------------------------
+// Learns per camera render times of each pass
+//---------------------------------------
+class RenderTimeModel
+{
+private:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Running mean & variance (Welford)
+	struct PassStats
+	{
+		size_t Count;
+		double Mean;
+		double M2;
+	};
+
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	std::map<std::string, PassStats> passStats;
+	mutable std::mutex statsLock;
+
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Generous until enough renders were measured, then a few deviations above the mean
+	float GetTimeout(
+		const std::string& pass,
+		size_t camCount
+	) const
+	{
+		float perCamera = RENDER_TIMEOUT;
+		{
+			std::lock_guard<std::mutex> lock(statsLock);
+			auto found = passStats.find(pass);
+			if (found != passStats.end() && found->second.Count >= RENDER_TIMEOUT_SAMPLES)
+			{
+				const PassStats& stats = found->second;
+				double deviation = std::sqrt(stats.M2 / static_cast<double>(stats.Count - 1));
+				perCamera = static_cast<float>(std::max(2.0 * stats.Mean, stats.Mean + 4.0 * deviation));
+			}
+		}
+		// Startup & scene loading is not part of the per camera time
+		return RENDER_TIMEOUT + camCount * perCamera;
+	}
+
+	// Adds the time of a successful render
+	void AddSample(
+		const std::string& pass,
+		float seconds,
+		size_t camCount
+	)
+	{
+		if (camCount == 0 || seconds <= 0.0f)
+			return;
+
+		double perCamera = static_cast<double>(seconds) / static_cast<double>(camCount);
+		std::lock_guard<std::mutex> lock(statsLock);
+		PassStats& stats = passStats[pass];
+		stats.Count++;
+		double delta = perCamera - stats.Mean;
+		stats.Mean += delta / static_cast<double>(stats.Count);
+		stats.M2 += delta * (perCamera - stats.Mean);
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	RenderTimeModel() :
+		passStats(),
+		statsLock()
+	{
+	}
+
+	// No copy / move allowed
+	RenderTimeModel(const RenderTimeModel& copy) = delete;
+	RenderTimeModel(RenderTimeModel&& other) = delete;
+};
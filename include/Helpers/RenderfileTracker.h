@@ -0,0 +1,407 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstring>
+
+#pragma warning(push, 0)
+#include <Helpers/RenderfileWriter.h>
+
+#include <Renderfile.h>
+#pragma warning(pop)
+
+//---------------------------------------
+// Hashes every member of the written object
+//---------------------------------------
+class MemberHashWriter : public RenderfileWriter
+{
+private:
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	std::map<std::string, size_t> memberHashes;
+	HashRenderfileWriter currHasher;
+	std::string currKey;
+	int depth;
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Member is complete once its value is back at object level
+	inline void X_EndValue()
+	{
+		if (depth == 1)
+			memberHashes[currKey] = currHasher.GetHash();
+	}
+
+public:
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	inline const std::map<std::string, size_t>& GetHashes() const { return memberHashes; }
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	virtual void StartObject() override
+	{
+		if (depth++ > 0)
+			currHasher.StartObject();
+	}
+
+	virtual void EndObject() override
+	{
+		if (--depth > 0)
+			currHasher.EndObject();
+		X_EndValue();
+	}
+
+	virtual void StartArray() override
+	{
+		depth++;
+		currHasher.StartArray();
+	}
+
+	virtual void EndArray() override
+	{
+		depth--;
+		currHasher.EndArray();
+		X_EndValue();
+	}
+
+	virtual void Key(const char* key) override
+	{
+		if (depth == 1)
+		{
+			currKey = key;
+			currHasher.Reset();
+		}
+		else
+		{
+			currHasher.Key(key);
+		}
+	}
+
+	virtual void String(const char* str, unsigned int length) override { currHasher.String(str, length); X_EndValue(); }
+	virtual void Double(double val) override { currHasher.Double(val); X_EndValue(); }
+	virtual void Bool(bool val) override { currHasher.Bool(val); X_EndValue(); }
+	virtual void Int(int val) override { currHasher.Int(val); X_EndValue(); }
+	virtual void Uint(unsigned int val) override { currHasher.Uint(val); X_EndValue(); }
+
+	virtual std::string GetRenderfile() const override
+	{
+		return std::string();
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	MemberHashWriter() :
+		RenderfileWriter(),
+		memberHashes(),
+		currHasher(),
+		currKey(),
+		depth(0)
+	{
+	}
+};
+
+//---------------------------------------
+// Writes the object with its ID & only the selected members
+//---------------------------------------
+class FilteredRenderfileWriter : public RenderfileWriter
+{
+private:
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	RenderfileWriter& target;
+	RenderfileWriter& skipped;
+	const std::set<std::string>& sendMembers;
+	const char* idKey;
+	int objectID;
+	bool isReplace;
+	RenderfileWriter* pOut;
+	int depth;
+
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	virtual void StartObject() override
+	{
+		if (depth++ == 0)
+		{
+			target.StartObject();
+			target.Key(idKey);
+			target.Int(objectID);
+			// Receiver has to drop members that are no longer written
+			if (isReplace)
+			{
+				target.Key("replace");
+				target.Bool(true);
+			}
+		}
+		else if (pOut)
+		{
+			pOut->StartObject();
+		}
+	}
+
+	virtual void EndObject() override
+	{
+		if (--depth == 0)
+			target.EndObject();
+		else if (pOut)
+			pOut->EndObject();
+	}
+
+	virtual void Key(const char* key) override
+	{
+		// ID was already written, unchanged members only count as skipped
+		if (depth == 1)
+			pOut = std::strcmp(key, idKey) == 0 ? NULL : sendMembers.count(key) > 0 ? &target : &skipped;
+		if (pOut)
+			pOut->Key(key);
+	}
+
+	virtual void StartArray() override { if (pOut) pOut->StartArray(); }
+	virtual void EndArray() override { if (pOut) pOut->EndArray(); }
+	virtual void String(const char* str, unsigned int length) override { if (pOut) pOut->String(str, length); }
+	virtual void Double(double val) override { if (pOut) pOut->Double(val); }
+	virtual void Bool(bool val) override { if (pOut) pOut->Bool(val); }
+	virtual void Int(int val) override { if (pOut) pOut->Int(val); }
+	virtual void Uint(unsigned int val) override { if (pOut) pOut->Uint(val); }
+
+	virtual std::string GetRenderfile() const override
+	{
+		return target.GetRenderfile();
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	FilteredRenderfileWriter(
+		RenderfileWriter& target,
+		RenderfileWriter& skipped,
+		const std::set<std::string>& members,
+		const char* idKey,
+		int id,
+		bool replace
+	) :
+		RenderfileWriter(),
+		target(target),
+		skipped(skipped),
+		sendMembers(members),
+		idKey(idKey),
+		objectID(id),
+		isReplace(replace),
+		pOut(NULL),
+		depth(0)
+	{
+	}
+};
+
+//---------------------------------------
+// Tracks render data a worker already holds
+//---------------------------------------
+class RenderfileTracker
+{
+private:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Member hashes per ID of one kind of entries (meshes, cameras, lights)
+	struct TrackedEntries
+	{
+		std::map<int, std::map<std::string, size_t>> Sent;
+		std::set<int> Current;
+		std::vector<int> Removed;
+	};
+
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	std::map<std::string, TrackedEntries> trackedEntries;
+	std::map<std::string, size_t> writtenEntries;
+	std::unique_ptr<RenderfileWriter> skippedWriter;
+	std::string renderFormat;
+	bool isEnabled;
+	bool hasState;
+	bool isDelta;
+
+public:
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	inline bool WasDelta() const { return isDelta; }
+
+	// Entries of a kind written to the last renderfile
+	inline size_t GetWritten(const std::string& kind) const
+	{
+		auto found = writtenEntries.find(kind);
+		return found != writtenEntries.end() ? found->second : 0;
+	}
+
+	// Encoded size of everything left out of the last renderfile (approximate)
+	inline size_t GetSkippedBytes() const { return isDelta ? skippedWriter->GetRenderfile().size() : 0; }
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Returns if only changes need to be sent
+	inline bool BeginUpdate()
+	{
+		for (auto& currEntries : trackedEntries)
+		{
+			currEntries.second.Current.clear();
+			currEntries.second.Removed.clear();
+		}
+		writtenEntries.clear();
+		isDelta = isEnabled && hasState;
+		// Left out data is encoded separately, only to report the savings
+		if (isDelta)
+		{
+			skippedWriter.reset(CreateRenderfileWriter(renderFormat));
+			skippedWriter->StartObject();
+		}
+		return isDelta;
+	}
+
+	// Writes entry with its ID & only the members that changed, false if left out completely
+	bool Write(
+		JSONWriterRef writer,
+		const std::string& kind,
+		const char* idKey,
+		int id,
+		const RenderfileData& data,
+		bool listAlways
+	)
+	{
+		// Nothing to track, always send everything
+		if (!isEnabled)
+		{
+			data.AddToJSON(writer);
+			writtenEntries[kind]++;
+			return true;
+		}
+
+		MemberHashWriter hasher;
+		data.AddToJSON(hasher);
+		TrackedEntries& entries = trackedEntries[kind];
+		entries.Current.insert(id);
+
+		// New or modified members since last renderfile
+		std::set<std::string> changed;
+		bool replace = false;
+		auto found = entries.Sent.find(id);
+		if (isDelta && found != entries.Sent.end())
+		{
+			for (const auto& currMember : hasher.GetHashes())
+			{
+				auto sentMember = found->second.find(currMember.first);
+				if (sentMember == found->second.end() || sentMember->second != currMember.second)
+					changed.insert(currMember.first);
+			}
+			// Optional members that disappeared can't be merged
+			for (const auto& sentMember : found->second)
+			{
+				replace |= hasher.GetHashes().count(sentMember.first) == 0;
+			}
+		}
+		if (!isDelta || found == entries.Sent.end() || replace)
+		{
+			changed.clear();
+			for (const auto& currMember : hasher.GetHashes())
+			{
+				changed.insert(currMember.first);
+			}
+		}
+		entries.Sent[id] = hasher.GetHashes();
+
+		// Unchanged entries the worker keeps are left out
+		if (changed.empty() && !listAlways)
+		{
+			skippedWriter->Key(idKey);
+			data.AddToJSON(*skippedWriter);
+			return false;
+		}
+
+		FilteredRenderfileWriter filtered(writer, isDelta ? *skippedWriter : writer, changed, idKey, id, replace);
+		data.AddToJSON(filtered);
+		writtenEntries[kind]++;
+		return true;
+	}
+
+	// Forgets entries that were not written since the last update
+	inline void EndUpdate()
+	{
+		for (auto& currEntries : trackedEntries)
+		{
+			TrackedEntries& entries = currEntries.second;
+			for (auto it = entries.Sent.begin(); it != entries.Sent.end();)
+			{
+				if (entries.Current.count(it->first) == 0)
+				{
+					entries.Removed.push_back(it->first);
+					it = entries.Sent.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+		hasState = isEnabled;
+	}
+
+	// Returns entries of a kind the worker needs to remove
+	inline std::vector<int> GetRemoved(
+		const std::string& kind
+	) const
+	{
+		auto found = trackedEntries.find(kind);
+		return found != trackedEntries.end() ? found->second.Removed : std::vector<int>();
+	}
+
+	// Worker lost its state
+	inline void Reset()
+	{
+		trackedEntries.clear();
+		hasState = false;
+		isDelta = false;
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	RenderfileTracker(
+		bool enabled,
+		const std::string& format
+	) :
+		trackedEntries(),
+		writtenEntries(),
+		skippedWriter(),
+		renderFormat(format),
+		isEnabled(enabled),
+		hasState(false),
+		isDelta(false)
+	{
+	}
+};
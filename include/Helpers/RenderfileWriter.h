@@ -0,0 +1,343 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+#pragma warning(push, 0)
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#pragma warning(pop)
+
+//---------------------------------------
+// Serializes render data (json-like interface)
+//---------------------------------------
+class RenderfileWriter
+{
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	virtual void StartObject() = 0;
+	virtual void EndObject() = 0;
+	virtual void StartArray() = 0;
+	virtual void EndArray() = 0;
+	virtual void Key(const char* key) = 0;
+	virtual void String(const char* str, unsigned int length) = 0;
+	virtual void Double(double val) = 0;
+	virtual void Bool(bool val) = 0;
+	virtual void Int(int val) = 0;
+	virtual void Uint(unsigned int val) = 0;
+
+	// Encoded renderfile
+	virtual std::string GetRenderfile() const = 0;
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	RenderfileWriter()
+	{
+	}
+
+	virtual ~RenderfileWriter()
+	{
+	}
+
+	// No copy / move allowed
+	RenderfileWriter(const RenderfileWriter& copy) = delete;
+	RenderfileWriter(RenderfileWriter&& other) = delete;
+};
+
+//---------------------------------------
+// Compact json renderfile
+//---------------------------------------
+class JSONRenderfileWriter : public RenderfileWriter
+{
+private:
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer;
+
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	virtual void StartObject() override { writer.StartObject(); }
+	virtual void EndObject() override { writer.EndObject(); }
+	virtual void StartArray() override { writer.StartArray(); }
+	virtual void EndArray() override { writer.EndArray(); }
+	virtual void Key(const char* key) override { writer.Key(key); }
+	virtual void String(const char* str, unsigned int length) override { writer.String(str, length); }
+	virtual void Double(double val) override { writer.Double(val); }
+	virtual void Bool(bool val) override { writer.Bool(val); }
+	virtual void Int(int val) override { writer.Int(val); }
+	virtual void Uint(unsigned int val) override { writer.Uint(val); }
+
+	virtual std::string GetRenderfile() const override
+	{
+		return std::string(buffer.GetString(), buffer.GetSize());
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	JSONRenderfileWriter() :
+		RenderfileWriter(),
+		buffer(),
+		writer(buffer)
+	{
+	}
+};
+
+//---------------------------------------
+// Binary (MessagePack) renderfile
+//---------------------------------------
+class BinaryRenderfileWriter : public RenderfileWriter
+{
+private:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Open map / array, count is patched when closed
+	struct Container
+	{
+		size_t Offset;
+		uint32_t Count;
+		bool IsMap;
+	};
+
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	std::string buffer;
+	std::vector<Container> openContainers;
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	inline void X_PutByte(uint8_t val)
+	{
+		buffer.push_back(static_cast<char>(val));
+	}
+
+	template<typename T>
+	inline void X_PutBigEndian(T val)
+	{
+		// MessagePack is always big endian
+		for (int i = sizeof(T) - 1; i >= 0; --i)
+		{
+			X_PutByte(static_cast<uint8_t>((val >> (i * 8)) & 0xFF));
+		}
+	}
+
+	inline void X_PutString(const char* str, uint32_t length)
+	{
+		if (length < 32)
+		{
+			X_PutByte(static_cast<uint8_t>(0xA0 | length));
+		}
+		else if (length <= 0xFF)
+		{
+			X_PutByte(0xD9);
+			X_PutByte(static_cast<uint8_t>(length));
+		}
+		else if (length <= 0xFFFF)
+		{
+			X_PutByte(0xDA);
+			X_PutBigEndian<uint16_t>(static_cast<uint16_t>(length));
+		}
+		else
+		{
+			X_PutByte(0xDB);
+			X_PutBigEndian<uint32_t>(length);
+		}
+		buffer.append(str, length);
+	}
+
+	inline void X_AddValue()
+	{
+		// Map entries are counted by their keys
+		if (!openContainers.empty() && !openContainers.back().IsMap)
+		{
+			openContainers.back().Count++;
+		}
+	}
+
+	inline void X_StartContainer(bool isMap)
+	{
+		X_AddValue();
+		// 32 bit count, patched once the size is known
+		X_PutByte(isMap ? 0xDF : 0xDD);
+		openContainers.push_back(Container{ buffer.size(), 0, isMap });
+		X_PutBigEndian<uint32_t>(0);
+	}
+
+	inline void X_EndContainer()
+	{
+		Container& closed = openContainers.back();
+		for (int i = 0; i < 4; ++i)
+		{
+			buffer[closed.Offset + i] = static_cast<char>((closed.Count >> ((3 - i) * 8)) & 0xFF);
+		}
+		openContainers.pop_back();
+	}
+
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	virtual void StartObject() override { X_StartContainer(true); }
+	virtual void EndObject() override { X_EndContainer(); }
+	virtual void StartArray() override { X_StartContainer(false); }
+	virtual void EndArray() override { X_EndContainer(); }
+
+	virtual void Key(const char* key) override
+	{
+		openContainers.back().Count++;
+		X_PutString(key, static_cast<uint32_t>(strlen(key)));
+	}
+
+	virtual void String(const char* str, unsigned int length) override
+	{
+		X_AddValue();
+		X_PutString(str, length);
+	}
+
+	virtual void Double(double val) override
+	{
+		X_AddValue();
+		uint64_t bits;
+		memcpy(&bits, &val, sizeof(double));
+		X_PutByte(0xCB);
+		X_PutBigEndian<uint64_t>(bits);
+	}
+
+	virtual void Bool(bool val) override
+	{
+		X_AddValue();
+		X_PutByte(val ? 0xC3 : 0xC2);
+	}
+
+	virtual void Int(int val) override
+	{
+		X_AddValue();
+		X_PutByte(0xD2);
+		X_PutBigEndian<uint32_t>(static_cast<uint32_t>(val));
+	}
+
+	virtual void Uint(unsigned int val) override
+	{
+		X_AddValue();
+		X_PutByte(0xCE);
+		X_PutBigEndian<uint32_t>(static_cast<uint32_t>(val));
+	}
+
+	virtual std::string GetRenderfile() const override
+	{
+		return buffer;
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	BinaryRenderfileWriter() :
+		RenderfileWriter(),
+		buffer(),
+		openContainers()
+	{
+		buffer.reserve(1 << 16);
+	}
+};
+
+//---------------------------------------
+// Only hashes the written data
+//---------------------------------------
+class HashRenderfileWriter : public RenderfileWriter
+{
+private:
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	size_t hashValue;
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	template<typename T>
+	inline void X_Combine(const T& val)
+	{
+		hashValue ^= std::hash<T>()(val) + 0x9e3779b9 + (hashValue << 6) + (hashValue >> 2);
+	}
+
+public:
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	inline size_t GetHash() const { return hashValue; }
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	inline void Reset() { hashValue = 0; }
+
+	virtual void StartObject() override { X_Combine<char>('{'); }
+	virtual void EndObject() override { X_Combine<char>('}'); }
+	virtual void StartArray() override { X_Combine<char>('['); }
+	virtual void EndArray() override { X_Combine<char>(']'); }
+	virtual void Key(const char* key) override { X_Combine<std::string>(key); }
+	virtual void String(const char* str, unsigned int length) override { X_Combine<std::string>(std::string(str, length)); }
+	virtual void Double(double val) override { X_Combine<double>(val); }
+	virtual void Bool(bool val) override { X_Combine<bool>(val); }
+	virtual void Int(int val) override { X_Combine<int>(val); }
+	virtual void Uint(unsigned int val) override { X_Combine<unsigned int>(val); }
+
+	virtual std::string GetRenderfile() const override
+	{
+		return std::string();
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	HashRenderfileWriter() :
+		RenderfileWriter(),
+		hashValue(0)
+	{
+	}
+};
+
+//---------------------------------------
+// Create writer for configured format
+//---------------------------------------
+static RenderfileWriter* CreateRenderfileWriter(
+	const std::string& format
+)
+{
+	if (format == "binary")
+	{
+		return new BinaryRenderfileWriter();
+	}
+	else
+	{
+		return new JSONRenderfileWriter();
+	}
+}
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <string>
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include <iostream>
 
 #pragma warning(push, 0)
+#include <Helpers/MeshCache.h>
 #include <Helpers/PathUtils.h>
 #pragma warning(pop)
 
 #define EXPORT_TO_FILE 0
+#define CACHE_MESH_FILES 1
 
 //---------------------------------------
 // Base class for all meshes
@@ -15,16 +20,26 @@
 class MeshBase
 {
 protected:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Immutable data shared by all instances of a mesh
+	struct MeshPrototype
+	{
+		int MeshId;
+		std::string MeshClass;
+		ModifiablePath MeshPath;
+		ModifiablePath TexturePath;
+	};
+
 	//---------------------------------------
 	// Fields
 	//---------------------------------------
 	int objId = -1;
-	int meshId = -1;
-	std::string meshClass = "none";
-
-	ModifiablePath meshPath;
-	ModifiablePath texturePath;
+	std::shared_ptr<const MeshPrototype> pPrototype;
 
+	// Only filled while loading, never copied
 	std::vector<float> vecVertices;
 	std::vector<int> vecIndices;
 	std::vector<float> vecNormals;
@@ -34,6 +49,7 @@ protected:
 	// Methods
 	//---------------------------------------
 	bool X_LoadFile();
+	bool X_ImportFile();
 	void X_StoreFile(const std::string& ext) const;
 	virtual void X_ExtractMesh() = 0;
 
@@ -48,11 +64,11 @@ public:
 	//---------------------------------------
 	inline int GetObjId() const { return objId; }
 	inline void SetObjId(int id) { objId = id; }
-	inline int GetMeshId() const { return meshId; }
-	inline std::string GetMeshClass() const { return meshClass; }
-	inline ModifiablePath GetMeshPath() const { return meshPath; }
-	inline ModifiablePath GetTexturePath() const { return texturePath; }
-	inline std::string GetName() const { return meshPath.stem().string(); }
+	inline int GetMeshId() const { return pPrototype->MeshId; }
+	inline const std::string& GetMeshClass() const { return pPrototype->MeshClass; }
+	inline const ModifiablePath& GetMeshPath() const { return pPrototype->MeshPath; }
+	inline const ModifiablePath& GetTexturePath() const { return pPrototype->TexturePath; }
+	inline std::string GetName() const { return pPrototype->MeshPath.stem().string(); }
 
 	//---------------------------------------
 	// Constructors
@@ -22,7 +22,6 @@ protected:
 	physx::PxShape* pPxShape;
 	physx::PxRigidActor* pPxActor;
 
-	bool firstInstance = false;
 	physx::PxBounds3 bounds = physx::PxBounds3(physx::PxVec3(-1e8), physx::PxVec3(1e8));
 
 	//---------------------------------------
@@ -30,7 +29,7 @@ protected:
 	//---------------------------------------
 
 	virtual bool X_IsStatic() = 0;
-	virtual void X_CookMesh() = 0;
+	virtual bool X_CookMesh() = 0;
 	virtual void X_ExtractMesh() = 0;
 	virtual void X_CreateMesh() = 0;
 	virtual void X_CreateShape() = 0;
@@ -49,7 +48,7 @@ public:
 	//---------------------------------------
 
 	virtual void CreateMesh() override;
-	void AddRigidActor(physx::PxScene* scene, physx::PxTransform trans);
+	void AddRigidActor(physx::PxScene* scene, physx::PxTransform trans, physx::PxU32 collisionGroup = 0);
 	void AddVelocity(physx::PxVec3 velocity);
 	void AddTorque(physx::PxVec3 torque);
 	void RemoveRigidActor(physx::PxScene* scene);
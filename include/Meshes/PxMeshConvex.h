@@ -21,12 +21,18 @@ private:
 	//---------------------------------------
 
 	virtual bool X_IsStatic() override;
-	virtual void X_CookMesh() override;
+	virtual bool X_CookMesh() override;
 	virtual void X_ExtractMesh() override;
 	virtual void X_CreateMesh() override;
 	virtual void X_CreateShape() override;
 
 public:
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	physx::PxConvexMeshGeometry GetGeometry() const;
+
 	//---------------------------------------
 	// Constructors
 	//---------------------------------------
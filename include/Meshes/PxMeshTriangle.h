@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstring>
+#include <cstdint>
+
 #pragma warning(push, 0)
+#include <Helpers/MeshSimplification.h>
+
 #include <Meshes/PxMesh.h>
 #pragma warning(pop)
 
@@ -15,18 +20,26 @@ private:
 	//---------------------------------------
 
 	physx::PxTriangleMesh* pPxMesh = NULL;
+	float simplifyError = 0.0f;
 
 	//---------------------------------------
 	// Methods
 	//---------------------------------------
 
 	virtual bool X_IsStatic() override;
-	virtual void X_CookMesh() override;
+	virtual bool X_CookMesh() override;
 	virtual void X_ExtractMesh() override;
 	virtual void X_CreateMesh() override;
 	virtual void X_CreateShape() override;
 
 public:
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	// Collision proxy: max surface deviation in mesh units (0: full mesh), set before creating
+	inline void SetSimplifyError(float error) { simplifyError = error > 0.0f ? error : 0.0f; }
+
 	//---------------------------------------
 	// Constructors
 	//---------------------------------------
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+#include <memory>
 #include <iostream>
 
 #pragma warning(push, 0)
@@ -21,7 +23,8 @@ protected:
 
 	bool indirect;
 	std::string shaderType;
-	OSLShader* oslShader;
+	// Shared with copies, shaders aren't changed once set
+	std::shared_ptr<const OSLShader> oslShader;
 
 	//---------------------------------------
 	// Methods
@@ -62,12 +65,9 @@ public:
 
 	inline std::string& GetShaderType() { return shaderType; }
 
-	inline const OSLShader* GetShader() const { return oslShader; }
-	inline void SetShader(OSLShader* shader)
-	{
-		delete oslShader;
-		oslShader = shader;
-	}
+	inline const OSLShader* GetShader() const { return oslShader.get(); }
+	inline void SetShader(OSLShader* shader) { oslShader.reset(shader); }
+	inline void SetShader(const std::shared_ptr<const OSLShader>& shader) { oslShader = shader; }
 
 	//---------------------------------------
 	// Methods
@@ -91,7 +91,7 @@ public:
 		RenderfileObject(),
 		indirect(indirect),
 		shaderType(meshShader),
-		oslShader(NULL)
+		oslShader()
 	{
 	}
 
@@ -111,12 +111,8 @@ public:
 		RenderfileObject(copy),
 		indirect(copy.indirect),
 		shaderType(copy.shaderType),
-		oslShader(NULL)
+		oslShader(copy.oslShader)
 	{
-		if (copy.oslShader)
-		{
-			oslShader = copy.oslShader->MakeCopy();
-		}
 	}
 
 	RenderMesh(RenderMesh&& other) :
@@ -125,13 +121,10 @@ public:
 	{
 		indirect = std::exchange(other.indirect, false);
 		shaderType = std::exchange(other.shaderType, "");
-		oslShader = std::exchange(other.oslShader, nullptr);
+		oslShader = std::move(other.oslShader);
 	}
 
 	~RenderMesh()
 	{
-		// Mesh is responsible for shader
-		delete oslShader;
-		oslShader = NULL;
 	}
 };
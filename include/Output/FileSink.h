@@ -0,0 +1,43 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <Output/OutputSink.h>
+#pragma warning(pop)
+
+//---------------------------------------
+// Stores every output as its own file
+//---------------------------------------
+class FileSink : public OutputSink
+{
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	virtual void Store(
+		int sample,
+		ReferencePath path,
+		std::string&& data
+	) override
+	{
+		boost::filesystem::ofstream osFile(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		osFile.write(data.data(), data.size());
+		osFile.close();
+	}
+
+	// Files are written immediately, incomplete samples are removed by the dataset tools
+	virtual void Commit(int sample) override {}
+	virtual void Discard(int sample) override {}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	FileSink() :
+		OutputSink()
+	{
+	}
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+
+#pragma warning(push, 0)
+#include <Helpers/PathUtils.h>
+#pragma warning(pop)
+
+//---------------------------------------
+// Destination of the final dataset output
+//---------------------------------------
+class OutputSink
+{
+protected:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Path relative to the final directory, e.g. rgb/img_000001.png
+	static inline std::string X_MemberName(
+		ReferencePath path
+	)
+	{
+		return (path.parent_path().filename() / path.filename()).generic_string();
+	}
+
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Adds an encoded file to a sample
+	virtual void Store(
+		int sample,
+		ReferencePath path,
+		std::string&& data
+	) = 0;
+
+	// Sample is complete
+	virtual void Commit(
+		int sample
+	) = 0;
+
+	// Sample is invalid
+	virtual void Discard(
+		int sample
+	) = 0;
+
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	// Samples can still be delivered, otherwise rendering should stop
+	virtual bool IsOpen() { return true; }
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	OutputSink()
+	{
+	}
+
+	virtual ~OutputSink()
+	{
+	}
+
+	// No copy / move allowed
+	OutputSink(const OutputSink& copy) = delete;
+	OutputSink(OutputSink&& other) = delete;
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+
+#pragma warning(push, 0)
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <Output/OutputSink.h>
+#pragma warning(pop)
+
+#define SHARD_BLOCK_SIZE 512
+
+//---------------------------------------
+// Packs samples into sequential tar shards
+//---------------------------------------
+class ShardSink : public OutputSink
+{
+private:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Single file of a sample
+	struct ShardMember
+	{
+		std::string Name;
+		std::string Data;
+	};
+
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	ModifiablePath shardDir;
+	ModifiablePath indexPath;
+	size_t maxShardBytes;
+
+	boost::filesystem::ofstream osShard;
+	boost::filesystem::ofstream osIndex;
+	int currShard;
+	size_t currShardBytes;
+
+	std::map<int, std::vector<ShardMember>> pendingSamples;
+	size_t discardedSamples;
+	std::mutex shardLock;
+
+	const char sep = ';';
+	const char end = '\n';
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	inline ModifiablePath X_GetShardPath(int shard) const
+	{
+		return shardDir / ("shard_" + FormatInt(shard) + ".tar");
+	}
+
+	inline void X_OpenShard()
+	{
+		// Continue after the last existing shard
+		while (boost::filesystem::exists(X_GetShardPath(currShard)))
+		{
+			currShard++;
+		}
+		osShard.open(X_GetShardPath(currShard), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		currShardBytes = 0;
+	}
+
+	inline void X_CloseShard()
+	{
+		if (osShard.is_open())
+		{
+			// Two empty blocks mark the end of a tar archive
+			const std::string trailer(2 * SHARD_BLOCK_SIZE, '\0');
+			osShard.write(trailer.data(), trailer.size());
+			osShard.close();
+		}
+	}
+
+	inline void X_WriteHeader(
+		const std::string& name,
+		size_t size
+	)
+	{
+		char header[SHARD_BLOCK_SIZE];
+		memset(header, 0, SHARD_BLOCK_SIZE);
+
+		// Plain ustar file entry
+		strncpy(header, name.c_str(), 99);
+		snprintf(header + 100, 8, "%07o", 0644);
+		snprintf(header + 108, 8, "%07o", 0);
+		snprintf(header + 116, 8, "%07o", 0);
+		snprintf(header + 124, 12, "%011llo", static_cast<unsigned long long>(size));
+		snprintf(header + 136, 12, "%011llo", static_cast<unsigned long long>(time(NULL)));
+		header[156] = '0';
+		memcpy(header + 257, "ustar", 6);
+		memcpy(header + 263, "00", 2);
+
+		// Checksum is computed with the checksum field set to spaces
+		memset(header + 148, ' ', 8);
+		unsigned int checksum = 0;
+		for (int i = 0; i < SHARD_BLOCK_SIZE; ++i)
+		{
+			checksum += static_cast<unsigned char>(header[i]);
+		}
+		snprintf(header + 148, 8, "%06o", checksum);
+		header[155] = ' ';
+
+		osShard.write(header, SHARD_BLOCK_SIZE);
+		currShardBytes += SHARD_BLOCK_SIZE;
+	}
+
+	inline void X_WriteMember(
+		int sample,
+		const ShardMember& member
+	)
+	{
+		// Header, then data padded to full blocks
+		X_WriteHeader(member.Name, member.Data.size());
+		size_t offset = currShardBytes;
+		osShard.write(member.Data.data(), member.Data.size());
+		size_t padding = (SHARD_BLOCK_SIZE - (member.Data.size() % SHARD_BLOCK_SIZE)) % SHARD_BLOCK_SIZE;
+		const std::string zeros(padding, '\0');
+		osShard.write(zeros.data(), zeros.size());
+		currShardBytes += member.Data.size() + padding;
+
+		// Store data location for random access
+		osIndex << sample << sep << member.Name << sep
+			<< X_GetShardPath(currShard).filename().string() << sep
+			<< offset << sep << member.Data.size() << end;
+	}
+
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	virtual void Store(
+		int sample,
+		ReferencePath path,
+		std::string&& data
+	) override
+	{
+		std::lock_guard<std::mutex> lock(shardLock);
+		pendingSamples[sample].push_back(ShardMember{ X_MemberName(path), std::move(data) });
+	}
+
+	virtual void Commit(
+		int sample
+	) override
+	{
+		std::lock_guard<std::mutex> lock(shardLock);
+		auto found = pendingSamples.find(sample);
+		if (found == pendingSamples.end())
+			return;
+
+		// Start a new shard once the current one is full
+		if (currShardBytes >= maxShardBytes)
+		{
+			X_CloseShard();
+			X_OpenShard();
+		}
+
+		// Members of a sample are always stored in the same shard
+		for (const auto& member : found->second)
+		{
+			X_WriteMember(sample, member);
+		}
+		osShard.flush();
+		osIndex.flush();
+
+		pendingSamples.erase(found);
+	}
+
+	virtual void Discard(
+		int sample
+	) override
+	{
+		std::lock_guard<std::mutex> lock(shardLock);
+		// Discarded samples are never committed
+		pendingSamples.erase(sample);
+		discardedSamples++;
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	ShardSink(
+		ReferencePath storePath,
+		size_t shardBytes
+	) :
+		OutputSink(),
+		shardDir(storePath / "shards"),
+		indexPath(storePath / "index.csv"),
+		maxShardBytes(shardBytes),
+		currShard(0),
+		currShardBytes(0),
+		discardedSamples(0)
+	{
+		boost::filesystem::create_directories(shardDir);
+
+		// Append to existing index, add header if new
+		bool hasIndex = boost::filesystem::exists(indexPath);
+		osIndex.open(indexPath, std::ios_base::out | std::ios_base::app);
+		if (!hasIndex)
+		{
+			osIndex << "Sample" << sep << "Member" << sep << "Shard" << sep
+				<< "Offset" << sep << "Size" << end;
+		}
+
+		X_OpenShard();
+	}
+
+	virtual ~ShardSink()
+	{
+		// Incomplete samples are lost
+		if (!pendingSamples.empty())
+		{
+			std::cout << pendingSamples.size() << " incomplete samples not stored" << std::endl;
+		}
+		if (discardedSamples > 0)
+		{
+			std::cout << discardedSamples << " invalid samples discarded" << std::endl;
+		}
+		X_CloseShard();
+		osIndex.close();
+	}
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <condition_variable>
+
+#pragma warning(push, 0)
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+#include <Output/OutputSink.h>
+#pragma warning(pop)
+
+//---------------------------------------
+// Streams samples to a local consumer
+//---------------------------------------
+class StreamSink : public OutputSink
+{
+private:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Single file of a sample
+	struct StreamMember
+	{
+		std::string Name;
+		std::string Data;
+	};
+
+	// Complete sample, ready to send
+	struct StreamSample
+	{
+		int Sample;
+		std::vector<StreamMember> Members;
+	};
+
+	//---------------------------------------
+	// Fields
+	//---------------------------------------
+
+	boost::asio::io_context ioContext;
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	boost::asio::local::stream_protocol::socket streamSocket;
+#endif
+	boost::thread* pSender;
+	bool isConnected;
+	bool isClosing;
+
+	std::map<int, std::vector<StreamMember>> pendingSamples;
+	size_t discardedSamples;
+	size_t lostSamples;
+	std::deque<StreamSample> sendQueue;
+	size_t maxQueued;
+	size_t sentSamples;
+
+	std::mutex streamLock;
+	std::condition_variable queueChanged;
+
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	template<typename T>
+	static inline void X_Append(
+		std::string& buffer,
+		T value
+	)
+	{
+		// Always little endian, independent of the host
+		for (size_t i = 0; i < sizeof(T); ++i)
+		{
+			buffer.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (i * 8)) & 0xFF));
+		}
+	}
+
+	bool X_Send(
+		const StreamSample& sample
+	)
+	{
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+		// Header: sample number & member count
+		std::string header;
+		X_Append<uint32_t>(header, static_cast<uint32_t>(sample.Sample));
+		X_Append<uint32_t>(header, static_cast<uint32_t>(sample.Members.size()));
+
+		std::vector<std::string> memberHeaders;
+		std::vector<boost::asio::const_buffer> buffers;
+		memberHeaders.reserve(sample.Members.size());
+		buffers.push_back(boost::asio::buffer(header));
+
+		// Each member: name length, name, data length, data
+		for (const auto& member : sample.Members)
+		{
+			memberHeaders.emplace_back();
+			X_Append<uint32_t>(memberHeaders.back(), static_cast<uint32_t>(member.Name.size()));
+			memberHeaders.back().append(member.Name);
+			X_Append<uint64_t>(memberHeaders.back(), static_cast<uint64_t>(member.Data.size()));
+			buffers.push_back(boost::asio::buffer(memberHeaders.back()));
+			buffers.push_back(boost::asio::buffer(member.Data));
+		}
+
+		// Blocks while the consumer is busy
+		boost::system::error_code error;
+		boost::asio::write(streamSocket, buffers, error);
+		if (error)
+		{
+			std::cout << "Stream closed by consumer: " << error.message() << std::endl;
+			return false;
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void X_SendLoop()
+	{
+		while (true)
+		{
+			StreamSample next;
+			{
+				std::unique_lock<std::mutex> lock(streamLock);
+				queueChanged.wait(lock, [&] { return isClosing || !sendQueue.empty(); });
+				// Queue is always emptied before closing
+				if (sendQueue.empty())
+					break;
+				next = std::move(sendQueue.front());
+				sendQueue.pop_front();
+			}
+			queueChanged.notify_all();
+
+			// Lost consumers are not reconnected, rendering stops
+			if (!X_Send(next))
+			{
+				std::lock_guard<std::mutex> lock(streamLock);
+				isConnected = false;
+				lostSamples += 1 + sendQueue.size();
+				sendQueue.clear();
+				queueChanged.notify_all();
+				break;
+			}
+			sentSamples++;
+		}
+	}
+
+public:
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	virtual void Store(
+		int sample,
+		ReferencePath path,
+		std::string&& data
+	) override
+	{
+		std::lock_guard<std::mutex> lock(streamLock);
+		// Only tracked to count the sample as lost
+		if (!isConnected)
+		{
+			pendingSamples[sample];
+			return;
+		}
+		pendingSamples[sample].push_back(StreamMember{ X_MemberName(path), std::move(data) });
+	}
+
+	virtual void Commit(
+		int sample
+	) override
+	{
+		std::unique_lock<std::mutex> lock(streamLock);
+		auto found = pendingSamples.find(sample);
+		if (found == pendingSamples.end())
+			return;
+		StreamSample complete{ sample, std::move(found->second) };
+		pendingSamples.erase(found);
+
+		// Back-pressure: wait until the consumer caught up
+		queueChanged.wait(lock, [&] { return !isConnected || sendQueue.size() < maxQueued; });
+		if (!isConnected)
+		{
+			lostSamples++;
+			return;
+		}
+
+		sendQueue.push_back(std::move(complete));
+		queueChanged.notify_all();
+	}
+
+	virtual void Discard(
+		int sample
+	) override
+	{
+		std::lock_guard<std::mutex> lock(streamLock);
+		// Discarded samples are never committed
+		pendingSamples.erase(sample);
+		discardedSamples++;
+	}
+
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	virtual bool IsOpen() override
+	{
+		std::lock_guard<std::mutex> lock(streamLock);
+		return isConnected;
+	}
+
+	//---------------------------------------
+	// Constructors
+	//---------------------------------------
+
+	StreamSink(
+		ReferencePath socketPath,
+		size_t queueSize
+	) :
+		OutputSink(),
+		ioContext(),
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+		streamSocket(ioContext),
+#endif
+		pSender(NULL),
+		isConnected(false),
+		isClosing(false),
+		discardedSamples(0),
+		lostSamples(0),
+		maxQueued(queueSize > 0 ? queueSize : 1),
+		sentSamples(0)
+	{
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+		// Without a consumer every sample would be lost
+		if (socketPath.empty())
+			throw std::runtime_error("Streaming output requires stream_path");
+
+		// Consumer has to be listening already
+		boost::system::error_code error;
+		streamSocket.connect(boost::asio::local::stream_protocol::endpoint(socketPath.string()), error);
+		if (error)
+			throw std::runtime_error("Can't connect to consumer " + socketPath.string() + ": " + error.message());
+		isConnected = true;
+		pSender = new boost::thread(&StreamSink::X_SendLoop, this);
+#else
+		throw std::runtime_error("Streaming output requires unix domain sockets");
+#endif
+	}
+
+	virtual ~StreamSink()
+	{
+		// Send remaining samples
+		{
+			std::lock_guard<std::mutex> lock(streamLock);
+			isClosing = true;
+		}
+		queueChanged.notify_all();
+		if (pSender)
+		{
+			pSender->join();
+			delete pSender;
+		}
+
+		if (!pendingSamples.empty())
+		{
+			std::cout << pendingSamples.size() << " incomplete samples not streamed" << std::endl;
+		}
+		std::cout << "Streamed " << sentSamples << " samples, discarded " << discardedSamples
+			<< ", lost " << lostSamples << " after the consumer disconnected" << std::endl;
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+		boost::system::error_code error;
+		streamSocket.shutdown(boost::asio::socket_base::shutdown_both, error);
+		streamSocket.close(error);
+#endif
+	}
+};
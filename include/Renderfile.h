@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <memory>
 
 #pragma warning(push, 0)
 #include <Eigen/Dense>
@@ -12,24 +13,6 @@
 
 #define RENDER_TIMEOUT 30.0f
 
-#define RENDERFILE_SINGLE(renderer, thread, builder, meshes, scene, cams, lights, out) \
-{\
-	rapidjson::StringBuffer renderstring;\
-	JSONWriter writer(renderstring);\
-	builder(writer, meshes, scene, cams, lights, out);\
-	std::string renderfile(renderstring.GetString());\
-	renderer->ProcessRenderfile(renderfile, cams.size() * RENDER_TIMEOUT, thread);\
-}
-
-#define RENDERFILE_DEPTH(renderer, thread, builder, meshes, scene, cams, lights, out, maxDist) \
-{\
-	rapidjson::StringBuffer renderstring;\
-	JSONWriter writer(renderstring);\
-	builder(writer, meshes, scene, cams, lights, out, maxDist);\
-	std::string renderfile(renderstring.GetString());\
-	renderer->ProcessRenderfile(renderfile, cams.size() * RENDER_TIMEOUT, thread);\
-}
-
 //---------------------------------------
 // Necessary for render related data
 //---------------------------------------
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cmath>
+#include <algorithm>
+
 #pragma warning(push, 0)
 #include <Helpers/JSONUtils.h>
 #include <Helpers/PathUtils.h>
@@ -33,6 +36,10 @@ private:
 	std::string shadingOverride;
 	float exposure;
 	bool useExposure;
+	Eigen::Vector4i cropWindow;
+	Eigen::Vector2i cropResolution;
+	bool useCrop;
+	bool useDenoise;
 
 	int imageNum;
 
@@ -71,6 +78,23 @@ private:
 			writer.Key("exposure");
 			AddFloat(writer, exposure);
 		}
+
+		writer.Key("denoise");
+		writer.Bool(useDenoise);
+
+		// Pixels outside are not rendered
+		if(useCrop && cropWindow.z() > 0 && cropWindow.w() > 0)
+		{
+			// Scale to render resolution, rounded outwards
+			float scaleX = static_cast<float>(resolution.x()) / static_cast<float>(cropResolution.x());
+			float scaleY = static_cast<float>(resolution.y()) / static_cast<float>(cropResolution.y());
+			int minX = static_cast<int>(std::floor(cropWindow.x() * scaleX));
+			int minY = static_cast<int>(std::floor(cropWindow.y() * scaleY));
+			int maxX = std::min(static_cast<int>(std::ceil((cropWindow.x() + cropWindow.z()) * scaleX)), resolution.x());
+			int maxY = std::min(static_cast<int>(std::ceil((cropWindow.y() + cropWindow.w()) * scaleY)), resolution.y());
+			writer.Key("crop");
+			AddEigenVector<Eigen::Vector4i>(writer, Eigen::Vector4i(minX, minY, maxX - minX, maxY - minY));
+		}
 	}
 
 public:
@@ -90,6 +114,17 @@ public:
 	inline void SetImageNum(int num) { imageNum = num; }
 	inline int GetImageNum() const { return imageNum; }
 
+	// x, y, width, height in pixels of an image with the given resolution (empty: whole image)
+	inline void SetCropWindow(const Eigen::Vector4i& crop, const Eigen::Vector2i& res)
+	{
+		cropWindow = crop;
+		cropResolution = res;
+	}
+	inline Eigen::Vector4i GetCropWindow() const { return cropWindow; }
+
+	// Renderer's own denoiser, reset by SetupRendering
+	inline void SetDenoise(bool denoise) { useDenoise = denoise; }
+
 	//---------------------------------------
 	// Methods
 	//---------------------------------------
@@ -101,7 +136,8 @@ public:
 		int sampleCount,
 		int maxRayBounces,
 		const std::string& shading,
-		bool usesExp
+		bool usesExp,
+		bool usesCrop = false
 	)
 	{
 		resultFile = outputFile;
@@ -111,6 +147,8 @@ public:
 		rayBounces = maxRayBounces;
 		shadingOverride = shading;
 		useExposure = usesExp;
+		useCrop = usesCrop;
+		useDenoise = true;
 	}
 
 	inline void LoadIntrinsics(const Settings& settings)
@@ -207,6 +245,11 @@ public:
 		aaSamples(16),
 		shadingOverride(""),
 		exposure(0.0f),
+		useExposure(false),
+		cropWindow(Eigen::Vector4i::Zero()),
+		cropResolution(Eigen::Vector2i::Ones()),
+		useCrop(false),
+		useDenoise(true),
 		imageNum(0)
 	{
 	}
@@ -225,6 +268,11 @@ public:
 		aaSamples(copy.aaSamples),
 		shadingOverride(copy.shadingOverride),
 		exposure(copy.exposure),
+		useExposure(copy.useExposure),
+		cropWindow(copy.cropWindow),
+		cropResolution(copy.cropResolution),
+		useCrop(copy.useCrop),
+		useDenoise(copy.useDenoise),
 		imageNum(copy.imageNum)
 	{
 	}
@@ -244,6 +292,11 @@ public:
 		aaSamples = std::exchange(other.aaSamples, 0);
 		shadingOverride = std::exchange(other.shadingOverride, "");
 		exposure = std::exchange(other.exposure, 0.0f);
+		useExposure = std::exchange(other.useExposure, false);
+		cropWindow = std::exchange(other.cropWindow, Eigen::Vector4i());
+		cropResolution = std::exchange(other.cropResolution, Eigen::Vector2i());
+		useCrop = std::exchange(other.useCrop, false);
+		useDenoise = std::exchange(other.useDenoise, true);
 		imageNum = std::exchange(other.imageNum, 0);
 	}
 
@@ -27,6 +27,14 @@ public:
 		std::vector<ModifiablePath> ShaderDirs;
 		Intrinsics CustomIntrinsics;
 		float RenderScale;
+		float AOScale;
+		int PBRSamples;
+		bool Denoise;
+		int DenoiseThreads;
+		std::string RenderfileFormat;
+		bool DeltaRenderfiles;
+		int WorkerMemLimit;
+		int ProducerThreads;
 	};
 
 	// Image filter paramters
@@ -48,6 +56,14 @@ public:
 		int BatchSize;
 		int SceneLimit;
 		int TotalLimit;
+		int PhysxThreads;
+		int LoadThreads;
+		int SimulationLayouts;
+		int SettleSteps;
+		float SettleLinear;
+		float SettleAngular;
+		float CollisionError;
+		std::string SimulationCache;
 	};
 
 	// Object spawning & forces
@@ -58,6 +74,17 @@ public:
 		Eigen::Vector3f VelocityMax;
 		Eigen::Vector3f TorqueMax;
 		float ApplyProbability;
+		std::string SpawnMode;
+		int SpawnAttempts;
+	};
+
+	// Dataset output
+	struct Output
+	{
+		std::string Format;
+		size_t ShardSize;
+		ModifiablePath StreamPath;
+		size_t StreamQueue;
 	};
 
 private:
@@ -70,9 +97,10 @@ private:
 	BlurDetection filterSettings;
 	Simulation simSettings;
 	Spawning spawnSettings;
+	Output outputSettings;
 
 	// Paths
-	ModifiablePath basePath, meshesPath, tempPath, finalPath, scenePath;
+	ModifiablePath basePath, meshesPath, tempPath, finalPath, scenePath, cachePath;
 
 	// Config file
 	rapidjson::Document jsonConfig;
@@ -86,6 +114,7 @@ public:
 	inline Settings::BlurDetection GetFilterSettings() const { return filterSettings; }
 	inline Settings::Simulation GetSimulationSettings() const { return simSettings; }
 	inline Settings::Spawning GetSpawnSettings() const { return spawnSettings; }
+	inline Settings::Output GetOutputSettings() const { return outputSettings; }
 
 	inline void SetScenePath(ReferencePath path) { scenePath = path; }
 	inline ModifiablePath GetScenePath() const { return scenePath; }
@@ -93,6 +122,7 @@ public:
 	inline ModifiablePath GetTemporaryPath() const { return tempPath; }
 	inline ModifiablePath GetFinalPath() const { return finalPath; }
 	inline ModifiablePath GetBasePath() const { return basePath; }
+	inline ModifiablePath GetCachePath() const { return cachePath; }
 
 	inline ModifiablePath GetImagePath(
 		const std::string& category,
@@ -141,6 +171,9 @@ public:
 		}
 		writer.EndArray();
 
+		writer.Key("cachePath");
+		AddString(writer, cachePath.string());
+
 		writer.EndObject();
 	}
 
@@ -156,6 +189,7 @@ public:
 		filterSettings(),
 		simSettings(),
 		spawnSettings(),
+		outputSettings(),
 		basePath(base)
 	{
 		using namespace boost::filesystem;
@@ -176,6 +210,13 @@ public:
 		// Init output paths
 		finalPath = weakly_canonical(absolute(ModifiablePath(SafeGet<const char*>(jsonConfig, "final_path")), basePath));
 		tempPath = weakly_canonical(absolute(ModifiablePath(SafeGet<const char*>(jsonConfig, "temp_path")), basePath));
+		// Persistent between runs, shared by all render processes
+		const rapidjson::Value* cacheVal;
+		cachePath = basePath / "cache";
+		if (SafeHasMember(jsonConfig, "cache_path", cacheVal) && cacheVal->IsString() && cacheVal->GetStringLength() > 0)
+		{
+			cachePath = weakly_canonical(absolute(ModifiablePath(cacheVal->GetString()), basePath));
+		}
 
 		// Init blur detection settings
 		filterSettings.EdgeThreshold = SafeGet<float>(jsonConfig, "edge_threshold");
@@ -191,6 +232,37 @@ public:
 		simSettings.BatchSize = SafeGet<int>(jsonConfig, "batch_size");
 		simSettings.SceneLimit = SafeGet<int>(jsonConfig, "scene_limit");
 		simSettings.TotalLimit = SafeGet<int>(jsonConfig, "total_limit");
+		// 0: Chosen by core count
+		int physxThreads = SafeGet<int>(jsonConfig, "physx_threads");
+		simSettings.PhysxThreads = physxThreads > 0 ? physxThreads : 0;
+		// 0: One per core
+		int loadThreads = SafeGet<int>(jsonConfig, "load_threads");
+		simSettings.LoadThreads = loadThreads > 0 ? loadThreads : 0;
+		// Independent object layouts per simulation
+		int layouts = SafeGet<int>(jsonConfig, "simulation_layouts");
+		simSettings.SimulationLayouts = layouts > 0 ? layouts : 1;
+		// 0: Always run all simulation steps
+		int settleSteps = SafeGet<int>(jsonConfig, "settle_steps");
+		simSettings.SettleSteps = settleSteps > 0 ? settleSteps : 0;
+		float settleLinear = SafeGet<float>(jsonConfig, "settle_linear");
+		simSettings.SettleLinear = settleLinear > 0.0f ? settleLinear : 0.01f;
+		float settleAngular = SafeGet<float>(jsonConfig, "settle_angular");
+		simSettings.SettleAngular = settleAngular > 0.0f ? settleAngular : 0.05f;
+		// 0: Scene collides with the full scan mesh, otherwise a proxy within this distance (m)
+		float collisionError = SafeGet<float>(jsonConfig, "collision_error");
+		simSettings.CollisionError = collisionError > 0.0f ? collisionError : 0.0f;
+		// Off, record (store simulated layouts) or replay (reuse stored layouts, simulate missing ones)
+		const rapidjson::Value* simCacheVal;
+		simSettings.SimulationCache = "off";
+		if (SafeHasMember(jsonConfig, "simulation_cache", simCacheVal) && simCacheVal->IsString())
+		{
+			simSettings.SimulationCache = simCacheVal->GetString();
+		}
+		if (simSettings.SimulationCache != "off" && simSettings.SimulationCache != "record" && simSettings.SimulationCache != "replay")
+		{
+			std::cout << "Unknown simulation_cache " << simSettings.SimulationCache << ", simulation cache is off." << std::endl;
+			simSettings.SimulationCache = "off";
+		}
 
 		// Init spawning settings
 		rapidjson::Value minSpawn = SafeGetArray(jsonConfig, "spawn_min");
@@ -202,6 +274,32 @@ public:
 		spawnSettings.VelocityMax = SafeGetEigenVector<Eigen::Vector3f>(velocityMax).cwiseAbs();
 		spawnSettings.TorqueMax = SafeGetEigenVector<Eigen::Vector3f>(torqueMax).cwiseAbs();
 		spawnSettings.ApplyProbability = SafeGet<float>(jsonConfig, "apply_probability");
+		// Uniform or overlap free (checked against scene & spaced out) placement
+		const rapidjson::Value* spawnModeVal;
+		spawnSettings.SpawnMode = "uniform";
+		if (SafeHasMember(jsonConfig, "spawn_mode", spawnModeVal) && spawnModeVal->IsString())
+		{
+			spawnSettings.SpawnMode = spawnModeVal->GetString();
+		}
+		int spawnAttempts = SafeGet<int>(jsonConfig, "spawn_attempts");
+		spawnSettings.SpawnAttempts = spawnAttempts > 0 ? spawnAttempts : 30;
+
+		// Init output settings (files, shards or stream, shard size in MB)
+		const rapidjson::Value* formatVal;
+		outputSettings.Format = "files";
+		if (SafeHasMember(jsonConfig, "output_format", formatVal) && formatVal->IsString())
+		{
+			outputSettings.Format = formatVal->GetString();
+		}
+		int shardSize = SafeGet<int>(jsonConfig, "shard_size");
+		outputSettings.ShardSize = static_cast<size_t>(shardSize > 0 ? shardSize : 256) << 20;
+		const rapidjson::Value* streamVal;
+		if (SafeHasMember(jsonConfig, "stream_path", streamVal) && streamVal->IsString() && streamVal->GetStringLength() > 0)
+		{
+			outputSettings.StreamPath = absolute(ModifiablePath(streamVal->GetString()), basePath);
+		}
+		int streamQueue = SafeGet<int>(jsonConfig, "stream_queue");
+		outputSettings.StreamQueue = static_cast<size_t>(streamQueue > 0 ? streamQueue : 8);
 
 		// Init render settings
 		engineSettings.LogLevel = SafeGet<const char*>(jsonConfig, "log_level");
@@ -210,6 +308,27 @@ public:
 		engineSettings.ShaderDirs.push_back(weakly_canonical(absolute(ModifiablePath(SafeGet<const char*>(jsonConfig, "shaders_path")))));
 		float scale = SafeGet<float>(jsonConfig, "render_scale");
 		engineSettings.RenderScale = scale > 0.1f ? scale : 0.1f;
+		// AO resolution relative to render scale (default: same)
+		float aoScale = SafeGet<float>(jsonConfig, "ao_scale");
+		engineSettings.AOScale = aoScale > 0.0f ? std::min(std::max(aoScale, 0.1f), 1.0f) : 1.0f;
+		// Fewer samples are fine if denoised afterwards
+		int pbrSamples = SafeGet<int>(jsonConfig, "pbr_samples");
+		engineSettings.PBRSamples = pbrSamples > 0 ? pbrSamples : 4;
+		engineSettings.Denoise = SafeGet<bool>(jsonConfig, "denoise");
+		int denoiseThreads = SafeGet<int>(jsonConfig, "denoise_threads");
+		engineSettings.DenoiseThreads = denoiseThreads > 0 ? denoiseThreads : 2;
+		const rapidjson::Value* renderfileVal;
+		engineSettings.RenderfileFormat = "json";
+		if (SafeHasMember(jsonConfig, "renderfile_format", renderfileVal) && renderfileVal->IsString())
+		{
+			engineSettings.RenderfileFormat = renderfileVal->GetString();
+		}
+		engineSettings.DeltaRenderfiles = SafeGet<bool>(jsonConfig, "renderfile_delta");
+		int memLimit = SafeGet<int>(jsonConfig, "worker_mem_limit");
+		engineSettings.WorkerMemLimit = memLimit > 0 ? memLimit : 4096;
+		// 0: One scene thread per render process
+		int producers = SafeGet<int>(jsonConfig, "producer_threads");
+		engineSettings.ProducerThreads = producers > 0 ? producers : 0;
 
 		// Init custom intrinsics
 		rapidjson::Value intrf = SafeGetArray(jsonConfig, "intrinsics_f");
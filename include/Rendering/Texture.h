@@ -10,6 +10,8 @@
 #include <Helpers/JSONUtils.h>
 #include <Helpers/PathUtils.h>
 
+#include <Output/OutputSink.h>
+
 #include <Renderfile.h>
 #pragma warning(pop)
 
@@ -29,6 +31,30 @@ private:
 	bool singleChannel;
 	bool isPacked;
 
+	//---------------------------------------
+	// Methods
+	//---------------------------------------
+
+	// Depth mapped to [0, 1] range
+	cv::Mat X_Depth01(float nearClip, float farClip) const
+	{
+		cv::Mat depth;
+		loadedImage.copyTo(depth);
+		depth.forEach<float>([&](float& val, const int pixel[]) -> void {
+			val = (val - nearClip) / (farClip - nearClip);
+		});
+		return depth;
+	}
+
+	// Stored next to the texture
+	ModifiablePath X_Depth01Path() const
+	{
+		ModifiablePath hrPath(filePath.parent_path());
+		hrPath.append(filePath.stem().string());
+		hrPath.concat("_01.tiff");
+		return hrPath;
+	}
+
 public:
 	//---------------------------------------
 	// Properties
@@ -123,21 +149,58 @@ public:
 		}
 	}
 
+	bool EncodeTexture(std::string& out) const
+	{
+		std::vector<uchar> encoded;
+		// Encode in memory according to file extension
+		if (loadedImage.empty() || !cv::imencode(filePath.extension().string(), loadedImage, encoded))
+		{
+			std::cout << "Can't encode " << filePath << std::endl;
+			return false;
+		}
+		out.assign(encoded.begin(), encoded.end());
+		return true;
+	}
+
+	void StoreTexture(
+		OutputSink& sink,
+		int sample
+	) const
+	{
+		// Final output is handed to the sink
+		std::string encoded;
+		if (EncodeTexture(encoded))
+		{
+			sink.Store(sample, filePath, std::move(encoded));
+		}
+	}
+
 	void StoreDepth01(float nearClip, float farClip)
 	{
 		if (loadedImage.type() == CV_32FC1)
 		{
-			cv::Mat depth;
-			// Map to [0, 1] range and save that image
-			loadedImage.copyTo(depth);
-			depth.forEach<float>([&](float& val, const int pixel[]) -> void {
-				val = (val - nearClip) / (farClip - nearClip);
-			});
 			// Store seperately
-			ModifiablePath hrPath(filePath.parent_path());
-			hrPath.append(filePath.stem().string());
-			hrPath.concat("_01.tiff");
-			cv::imwrite(hrPath.string(), depth);
+			cv::imwrite(X_Depth01Path().string(), X_Depth01(nearClip, farClip));
+		}
+	}
+
+	void StoreDepth01(
+		OutputSink& sink,
+		int sample,
+		float nearClip,
+		float farClip
+	) const
+	{
+		if (loadedImage.type() == CV_32FC1)
+		{
+			// Part of the sample, like the texture itself
+			std::vector<uchar> encoded;
+			if (!cv::imencode(".tiff", X_Depth01(nearClip, farClip), encoded))
+			{
+				std::cout << "Can't encode " << X_Depth01Path() << std::endl;
+				return;
+			}
+			sink.Store(sample, X_Depth01Path(), std::string(encoded.begin(), encoded.end()));
 		}
 	}
 
@@ -211,11 +274,12 @@ public:
 		blendedDepth.SetPath(path, false);
 		blendedDepth.StoreTexture();
 	}
-	inline void StoreBlendedDepth01(ReferencePath path, float nearClip, float farClip)
+	inline void StoreBlendedDepth01(ReferencePath path, OutputSink& sink, int sample, float nearClip, float farClip)
 	{
 		blendedDepth.SetPath(path, false);
-		blendedDepth.StoreDepth01(nearClip, farClip);
+		blendedDepth.StoreDepth01(sink, sample, nearClip, farClip);
 	}
+	inline Texture& GetBlendedDepth() { return blendedDepth; }
 
 	//---------------------------------------
 	// Constructors
@@ -1,19 +1,33 @@
 #pragma once
 
+#include <deque>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <memory>
 #include <random>
 #include <thread>
+#include <numeric>
+#include <fstream>
 
 #pragma warning(push, 0)
 #include <boost/algorithm/string.hpp>
 #include <boost/thread.hpp>
 
 #include <Helpers/Annotations.h>
+#include <Helpers/Denoiser.h>
 #include <Helpers/ImageProcessing.h>
 #include <Helpers/JSONUtils.h>
 #include <Helpers/PathUtils.h>
 #include <Helpers/PhysxManager.h>
+#include <Helpers/PxSpawner.h>
+#include <Helpers/RenderfileTracker.h>
+#include <Helpers/RenderJob.h>
+#include <Helpers/RenderPool.h>
+
+#include <Output/FileSink.h>
+#include <Output/ShardSink.h>
+#include <Output/StreamSink.h>
 
 #include <BlenderLib/BlenderRenderer.h>
 
@@ -39,12 +53,46 @@
 class SceneManager
 {
 private:
+	//---------------------------------------
+	// Types
+	//---------------------------------------
+
+	// Batch with submitted but unprocessed renders
+	struct PendingBatch
+	{
+		std::vector<Camera> Cams;
+		std::vector<Mask> Masks;
+		std::vector<SceneImage> Images;
+		std::vector<Texture> Labels;
+		std::vector<Texture> AOs;
+		std::vector<Texture> PBRs;
+		std::vector<Texture> Albedos;
+		std::vector<Texture> Normals;
+		std::unique_ptr<RenderJob> LabelJob;
+		std::unique_ptr<RenderJob> AOJob;
+		std::unique_ptr<RenderJob> PBRJob;
+		std::unique_ptr<RenderJob> AlbedoJob;
+		std::unique_ptr<RenderJob> NormalJob;
+	};
+
+	// Final pose of a simulated object (physx system)
+	struct SimulatedObject
+	{
+		int ObjId;
+		int MeshId;
+		physx::PxTransform Pose;
+	};
+
 	//---------------------------------------
 	// Fields
 	//---------------------------------------
 
 	// Rendering
 	Camera camBlueprint;
+	Blender::BlenderRenderer* pRenderer;
+	RenderPool* pRenderPool;
+	Denoiser* pDenoiser;
+	int processCount;
 
 	// Meshes (Blueprint)
 	const std::vector<PxMeshConvex*> vecpPxMeshObjs;
@@ -52,12 +100,17 @@ private:
 
 	// Other
 	const Settings& renderSettings;
+	OutputSink* pOutputSink;
 
 	// Multithreading
 	int imgCountDepth;
 	int imgCountUnoccluded;
 	int imgCountScene;
 
+	// Steps until settled, per iteration
+	std::vector<int> simStepCounts;
+	std::mutex simStepLock;
+
 	//---------------------------------------
 	// Methods
 	//---------------------------------------
@@ -78,23 +131,52 @@ private:
 	std::vector<PxMeshConvex> X_PxCreateObjs(
 		std::default_random_engine& generator,
 		PxMeshTriangle& sceneMesh,
-		physx::PxScene* simulation
+		physx::PxScene* simulation,
+		physx::PxU32 collisionGroup
 	) const;
 
-	std::vector<RenderMesh> X_PxSaveSimResults(
+	std::vector<SimulatedObject> X_PxSaveSimResults(
 		std::vector<PxMeshConvex>& simulationObjs
 	) const;
 
-	void X_PxRunSim(
+	std::vector<RenderMesh> X_ConvertSimResults(
+		const std::vector<SimulatedObject>& simulatedObjs
+	) const;
+
+	int X_PxRunSim(
 		physx::PxScene* simulation,
 		float timestep,
 		int stepCount
 	) const;
 
+	// Simulation cache
+
+	ModifiablePath X_GetSimCachePath(
+		int iteration
+	) const;
+
+	void X_AddSimParams(
+		JSONWriterRef writer
+	) const;
+
+	void X_StoreSimResults(
+		int iteration,
+		unsigned int seed,
+		int layout,
+		const std::vector<SimulatedObject>& simulatedObjs
+	) const;
+
+	bool X_LoadSimResults(
+		int iteration,
+		std::vector<SimulatedObject>& simulatedObjs
+	) const;
+
 	// Renderfile creation
 
 	void X_ConvertToRenderfile(
 		JSONWriterRef writer,
+		RenderfileTracker& tracker,
+		RenderMesh* sceneMesh,
 		std::vector<RenderMesh>& meshes,
 		std::vector<Camera>& cams,
 		std::vector<Light>& lights
@@ -102,6 +184,7 @@ private:
 
 	void X_BuildSceneDepth(
 		JSONWriterRef writer,
+		RenderfileTracker& tracker,
 		RenderMesh& sceneMesh,
 		std::vector<RenderMesh>& meshes,
 		std::vector<Camera>& cams,
@@ -112,6 +195,7 @@ private:
 
 	void X_BuildObjectsDepth(
 		JSONWriterRef writer,
+		RenderfileTracker& tracker,
 		RenderMesh& sceneMesh,
 		std::vector<RenderMesh>& meshes,
 		std::vector<Camera>& cams,
@@ -122,6 +206,7 @@ private:
 
 	void X_BuildObjectsLabel(
 		JSONWriterRef writer,
+		RenderfileTracker& tracker,
 		RenderMesh& sceneMesh,
 		std::vector<RenderMesh>& meshes,
 		std::vector<Camera>& cams,
@@ -131,6 +216,7 @@ private:
 
 	void X_BuildObjectsPBR(
 		JSONWriterRef writer,
+		RenderfileTracker& tracker,
 		RenderMesh& sceneMesh,
 		std::vector<RenderMesh>& meshes,
 		std::vector<Camera>& cams,
@@ -140,6 +226,7 @@ private:
 
 	void X_BuildObjectsAO(
 		JSONWriterRef writer,
+		RenderfileTracker& tracker,
 		RenderMesh& sceneMesh,
 		std::vector<RenderMesh>& meshes,
 		std::vector<Camera>& cams,
@@ -147,10 +234,26 @@ private:
 		std::vector<Texture>& results
 	) const;
 
+	void X_BuildObjectsFeature(
+		JSONWriterRef writer,
+		RenderfileTracker& tracker,
+		RenderMesh& sceneMesh,
+		std::vector<RenderMesh>& meshes,
+		std::vector<Camera>& cams,
+		std::vector<Light>& lights,
+		std::vector<Texture>& results,
+		const std::string& feature
+	) const;
+
+	void X_SetPBRShaders(
+		RenderMesh& sceneMesh,
+		std::vector<RenderMesh>& meshes
+	) const;
+
 	// Blender rendering
 
 	std::vector<Mask> X_RenderDepthMasks(
-		Blender::BlenderRenderer* renderer,
+		RenderPool* pool,
 		int threadID,
 		RenderMesh& sceneMesh,
 		std::vector<RenderMesh>& meshes,
@@ -160,35 +263,44 @@ private:
 		float maxDist
 	) const;
 
-	void X_RenderSegments(
-		Blender::BlenderRenderer* renderer,
+	std::unique_ptr<PendingBatch> X_SubmitBatch(
+		RenderPool* pool,
 		int threadID,
-		AnnotationsManager* annotations,
 		RenderMesh& sceneMesh,
 		std::vector<RenderMesh>& meshes,
-		std::vector<Camera>& cams,
 		std::vector<Light>& lights,
-		std::vector<Mask>& masks
+		std::vector<Camera>&& cams,
+		std::vector<Mask>&& masks,
+		std::vector<SceneImage>&& sceneRGBs
+	) const;
+
+	void X_RenderSegments(
+		AnnotationsManager* annotations,
+		std::vector<RenderMesh>& meshes,
+		PendingBatch& batch
 	) const;
 
 	void X_RenderPBRBlend(
+		PendingBatch& batch
+	) const;
+
+	void X_FinishBatch(
 		Blender::BlenderRenderer* renderer,
 		int threadID,
-		RenderMesh& sceneMesh,
+		AnnotationsManager* annotations,
 		std::vector<RenderMesh>& meshes,
-		std::vector<Camera>& cams,
-		std::vector<Light>& lights,
-		std::vector<Mask>& masks,
-		std::vector<SceneImage>& sceneRGBs
+		PendingBatch& batch
 	) const;
 
 	// Other
 
 	void X_CleanupScene(
 		physx::PxScene* simulation,
-		AnnotationsManager* annotations,
-		Blender::BlenderRenderer* renderer,
-		int threadID
+		AnnotationsManager* annotations
+	) const;
+
+	void X_PrewarmTextures(
+		const std::vector<Texture>& textures
 	) const;
 
 	std::vector<Light> X_PlaceLights(
@@ -209,7 +321,7 @@ private:
 	) const;
 
 	void X_ProcessThread(
-		Blender::BlenderRenderer* renderer,
+		RenderPool* pool,
 		boost::mutex* syncPoint,
 		int threadID
 	);
@@ -221,6 +333,13 @@ public:
 
 	int ProcessNext(int imageCount);
 
+	//---------------------------------------
+	// Properties
+	//---------------------------------------
+
+	// False once the output can't take samples anymore
+	inline bool IsOutputOpen() const { return pOutputSink->IsOpen(); }
+
 	//---------------------------------------
 	// Constructors
 	//---------------------------------------
@@ -230,4 +349,5 @@ public:
 		const std::vector<PxMeshConvex*>& vecPxMeshObjs,
 		const std::vector<RenderMesh*>& vecRenderMeshObjs
 	);
+	~SceneManager();
 };
@@ -1,5 +1,13 @@
 #pragma once
 
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
 #pragma warning(push, 0)
 #include <rapidjson/filereadstream.h>
 
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <stdexcept>
 
 #pragma warning(push, 0)
 #include <boost/filesystem.hpp>
@@ -41,11 +42,20 @@ int main(int argc, char** argv)
 	rapidjson::Document json;
 	if (CanReadJSONFile(configPath.string(), json))
 	{
-		// Create simulation manager
-		SimManager simulation(new Settings(MOVE_DOC(json), configPath.parent_path()));
+		try
+		{
+			// Create simulation manager
+			SimManager simulation(new Settings(MOVE_DOC(json), configPath.parent_path()));
 
-		// Run the simulation
-		simulation.RunSimulation();
+			// Run the simulation
+			simulation.RunSimulation();
+		}
+		catch (const std::exception& error)
+		{
+			// Setup errors that would make the whole run useless
+			std::cout << error.what() << ", exiting." << std::endl;
+			return -1;
+		}
 
 		return 0;
 	}
@@ -5,26 +5,70 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <assimp/Exporter.hpp>
+#include <assimp/version.h>
 #pragma warning(pop)
 
 #pragma warning(disable:26451)
 
 //---------------------------------------
-// Try to load mesh from disk
+// Try to load mesh from cache or disk
 //---------------------------------------
 bool MeshBase::X_LoadFile()
+{
+	// Mesh file must exist
+	if (!boost::filesystem::exists(GetMeshPath()))
+		return false;
+
+#if CACHE_MESH_FILES
+	// Cache depends on the file contents & the importer
+	uint64_t cacheKey = 14695981039346656037ull;
+	bool canCache = MeshCache::HashFile(GetMeshPath(), cacheKey);
+	if (canCache)
+	{
+		uint32_t importer[3] = { aiGetVersionMajor(), aiGetVersionMinor(), aiGetVersionRevision() };
+		cacheKey = MeshCache::Hash(cacheKey, importer, sizeof(importer));
+		if (MeshCache::Read(MeshCache::GetCachePath(GetMeshPath()), cacheKey, MeshCache::MeshData{ vecVertices, vecIndices, vecNormals, vecUVs }))
+		{
+			std::cout << "\33[2K\r" << "Cached mesh:\t" << boost::filesystem::relative(GetMeshPath()) << std::flush;
+			return true;
+		}
+	}
+#endif //CACHE_MESH_FILES
+
+	// Not cached or damaged cache
+	vecVertices.clear();
+	vecIndices.clear();
+	vecNormals.clear();
+	vecUVs.clear();
+	if (!X_ImportFile())
+		return false;
+
+#if CACHE_MESH_FILES
+	if (canCache)
+	{
+		MeshCache::Write(MeshCache::GetCachePath(GetMeshPath()), cacheKey, MeshCache::MeshData{ vecVertices, vecIndices, vecNormals, vecUVs });
+	}
+#endif //CACHE_MESH_FILES
+	return true;
+}
+
+//---------------------------------------
+// Import mesh with assimp (positions & indices only)
+//---------------------------------------
+bool MeshBase::X_ImportFile()
 {
 	Assimp::Importer importer;
 	// Removes degenerate faces, lines & points from mesh
 	importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_LINE | aiPrimitiveType_POINT);
 
-	// Mesh file must exist
-	if (!boost::filesystem::exists(meshPath))
-		return false;
+	// Only physics loads meshes, other components are removed first so more vertices can be joined
+	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS,
+		aiComponent_NORMALS | aiComponent_TANGENTS_AND_BITANGENTS | aiComponent_COLORS | aiComponent_TEXCOORDS);
+	unsigned int postProcess = aiProcess_RemoveComponent | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices |
+		aiProcess_FindDegenerates | aiProcess_SortByPType;
 
-	// Read and load mesh with assimp, improve mesh
-	const aiScene* scene = importer.ReadFile(meshPath.string(),
-		aiProcessPreset_TargetRealtime_MaxQuality & ~aiProcess_SplitLargeMeshes);
+	// Read and load mesh with assimp
+	const aiScene* scene = importer.ReadFile(GetMeshPath().string(), postProcess);
 
 	// Error handling
 	if (!scene)
@@ -34,12 +78,12 @@ bool MeshBase::X_LoadFile()
 	}
 	else if (!scene->HasMeshes())
 	{
-		std::cout << "\33[2K\r" << "Mesh load error:\t" << boost::filesystem::relative(meshPath) << " has no mesh" << std::endl;
+		std::cout << "\33[2K\r" << "Mesh load error:\t" << boost::filesystem::relative(GetMeshPath()) << " has no mesh" << std::endl;
 		return false;
 	}
 	else
 	{
-		std::cout << "\33[2K\r" << "Imported mesh:\t" << boost::filesystem::relative(meshPath) << std::flush;
+		std::cout << "\33[2K\r" << "Imported mesh:\t" << boost::filesystem::relative(GetMeshPath()) << std::flush;
 	}
 
 	const aiMesh* mesh = scene->mMeshes[0];
@@ -175,8 +219,8 @@ void MeshBase::X_StoreFile(const std::string& ext) const
 	}
 
 	// Build path
-	ModifiablePath savePath(meshPath.parent_path());
-	savePath.append(meshPath.stem().string());
+	ModifiablePath savePath(GetMeshPath().parent_path());
+	savePath.append(GetMeshPath().stem().string());
 	savePath.concat(ext + ".obj");
 
 	// Export created mesh to path
@@ -190,10 +234,7 @@ void MeshBase::X_StoreFile(const std::string& ext) const
 //---------------------------------------
 MeshBase::MeshBase(ReferencePath meshPath, ReferencePath texturePath, const std::string& meshClass, int meshId) :
 	objId(-1),
-	meshId(meshId),
-	meshClass(meshClass),
-	meshPath(meshPath),
-	texturePath(texturePath)
+	pPrototype(std::make_shared<MeshPrototype>(MeshPrototype{ meshId, meshClass, meshPath, texturePath }))
 {
 }
 
@@ -206,27 +247,21 @@ MeshBase::MeshBase(ReferencePath meshPath, const std::string& meshClass, int mes
 }
 
 //---------------------------------------
-// Copy constructor
+// Copy constructor (shares the prototype)
 //---------------------------------------
 MeshBase::MeshBase(const MeshBase& copy) :
 	objId(copy.objId),
-	meshId(copy.meshId),
-	meshClass(copy.meshClass),
-	meshPath(copy.meshPath),
-	texturePath(copy.texturePath)
+	pPrototype(copy.pPrototype)
 {
 }
 
 //---------------------------------------
-// Move constructor
+// Move constructor (prototype stays valid in both)
 //---------------------------------------
-MeshBase::MeshBase(MeshBase&& other)
+MeshBase::MeshBase(MeshBase&& other) :
+	pPrototype(other.pPrototype)
 {
 	objId = std::exchange(other.objId, -1);
-	meshId = std::exchange(other.meshId, -1);
-	meshClass = std::exchange(other.meshClass, "");
-	std::swap(meshPath, other.meshPath);
-	std::swap(texturePath, other.texturePath);
 	std::swap(vecVertices, other.vecVertices);
 	std::swap(vecIndices, other.vecIndices);
 	std::swap(vecNormals, other.vecNormals);
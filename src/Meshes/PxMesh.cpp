@@ -5,7 +5,7 @@ using namespace physx;
 //---------------------------------------
 // Create & add actor to scene
 //---------------------------------------
-void PxMesh::AddRigidActor(PxScene* scene, PxTransform trans)
+void PxMesh::AddRigidActor(PxScene* scene, PxTransform trans, PxU32 collisionGroup)
 {
 	// Remove existing actor
 	if (pPxActor)
@@ -40,6 +40,10 @@ void PxMesh::AddRigidActor(PxScene* scene, PxTransform trans)
 	// Create & add the shape
 	X_CreateShape();
 
+	// Group 0 collides with everything, others only with themselves
+	if (pPxShape)
+		pPxShape->setSimulationFilterData(PxFilterData(collisionGroup, 0, 0, 0));
+
 	// Add actor to scene
 	scene->addActor(*pPxActor);
 }
@@ -81,8 +85,8 @@ void PxMesh::AddTorque(physx::PxVec3 torque)
 //---------------------------------------
 void PxMesh::RemoveRigidActor(PxScene* scene)
 {
-	// Only possible if actor exists
-	if (pPxActor)
+	// Only possible if actor exists & is part of the scene
+	if (pPxActor && pPxActor->getScene() == scene)
 	{
 		scene->removeActor(*pPxActor);
 	}
@@ -273,7 +277,6 @@ PxMesh::PxMesh(
 PxMesh::PxMesh(const PxMesh& copy) :
 	pPxShape(copy.pPxShape),
 	pPxActor(copy.pPxActor),
-	firstInstance(false),
 	bounds(copy.bounds),
 	MeshBase(copy),
 	Transformable(
@@ -294,7 +297,6 @@ PxMesh::PxMesh(PxMesh&& other) :
 {
 	pPxShape = std::exchange(other.pPxShape, nullptr);
 	pPxActor = std::exchange(other.pPxActor, nullptr);
-	std::swap(firstInstance, other.firstInstance);
 	std::swap(bounds, other.bounds);
 }
 
@@ -11,59 +11,49 @@ bool PxMeshConvex::X_IsStatic()
 }
 
 //---------------------------------------
-// Cooks or loads a mesh
+// Cooks or loads a mesh, true if newly created
 //---------------------------------------
-void PxMeshConvex::X_CookMesh()
+bool PxMeshConvex::X_CookMesh()
 {
 	// Return if mesh already loaded
 	if (pPxMesh)
-		return;
+		return false;
 
-	// Path to cooked mesh
-	ModifiablePath cookPath(meshPath); cookPath.concat("px");
-	// If cooked mesh not on disk
-	if (!boost::filesystem::exists(cookPath))
-	{
-		// Load mesh file
-		X_LoadFile();
-
-		// Create convex mesh
-		PxConvexMeshDesc convDesc;
-		convDesc.points.count = vecVertices.size() / 3;
-		convDesc.points.stride = sizeof(float) * 3;
-		convDesc.points.data = X_GetVertices();
-		convDesc.indices.count = vecIndices.size();
-		convDesc.indices.stride = sizeof(int);
-		convDesc.indices.data = X_GetIndices();
-		convDesc.flags |= PxConvexFlag::eCOMPUTE_CONVEX;
-		convDesc.flags |= PxConvexFlag::eSHIFT_VERTICES;
-		convDesc.flags |= PxConvexFlag::eGPU_COMPATIBLE;
-
-		// Cook the mesh
+	// Flags change the cooked mesh, part of the registry key
+	PxConvexFlags convFlags = PxConvexFlag::eCOMPUTE_CONVEX | PxConvexFlag::eSHIFT_VERTICES | PxConvexFlag::eGPU_COMPATIBLE;
+
+	// Shared with every other instance of the file, only cooked if not cached
+	bool created = false;
+	pPxMesh = PxManager::GetInstance().GetMeshRegistry()->AcquireConvex(GetMeshPath().string(), static_cast<PxU16>(convFlags),
+		[&](PxOutputStream& cookBuffer)
+		{
+			// Load mesh file, only positions are cooked
+			X_LoadFile();
+
+			// Create convex mesh
+			PxConvexMeshDesc convDesc;
+			convDesc.points.count = vecVertices.size() / 3;
+			convDesc.points.stride = sizeof(float) * 3;
+			convDesc.points.data = X_GetVertices();
+			convDesc.indices.count = vecIndices.size();
+			convDesc.indices.stride = sizeof(int);
+			convDesc.indices.data = X_GetIndices();
+			convDesc.flags = convFlags;
+
+			// Cook the mesh into memory
 #pragma warning(disable:26812)
-		PxConvexMeshCookingResult::Enum result;
+			PxConvexMeshCookingResult::Enum result;
 #pragma warning(default:26812)
-		PxDefaultFileOutputStream writeOutBuffer(cookPath.string().c_str());
-		if (!PxManager::GetInstance().GetCooker()->cookConvexMesh(convDesc, writeOutBuffer, &result))
-		{
-			std::cout << "\33[2K\r" << GetName() << " cooking error:\t" << result << std::endl;
-		}
-		else
-		{
-			std::cout << "\33[2K\r" << GetName() << " cooked to:\t" << boost::filesystem::relative(cookPath) << std::flush;
-		}
-	}
-	else
-	{
-		std::cout << "\33[2K\r" << GetName() << " loaded from:\t" << boost::filesystem::relative(cookPath) << std::flush;
-	}
-
-	// Create buffer
-	PxDefaultFileInputData readInBuffer(cookPath.string().c_str());
-	// Create the mesh from buffer
-	pPxMesh = PxGetPhysics().createConvexMesh(readInBuffer);
-	// This mesh has to release the mesh
-	firstInstance = true;
+			if (!PxManager::GetInstance().GetCooker()->cookConvexMesh(convDesc, cookBuffer, &result))
+			{
+				std::cout << "\33[2K\r" << GetName() << " cooking error:\t" << result << std::endl;
+				return false;
+			}
+			return true;
+		},
+		created
+	);
+	return created;
 }
 
 //---------------------------------------
@@ -123,15 +113,22 @@ void PxMeshConvex::X_CreateShape()
 	if (!pPxMesh)
 		return;
 
+	// Create shape from the descriptor
+	pPxShape = PxRigidActorExt::createExclusiveShape(*pPxActor, GetGeometry(), *PxManager::GetInstance().GetMaterial());
+	pPxShape->setName(GetName().c_str());
+}
+
+//---------------------------------------
+// Scaled geometry, also usable without actor
+//---------------------------------------
+PxConvexMeshGeometry PxMeshConvex::GetGeometry() const
+{
 	// Create mesh descriptor
 	PxConvexMeshGeometry meshGeom;
 	meshGeom.convexMesh = pPxMesh;
 	meshGeom.meshFlags = PxConvexMeshGeometryFlag::eTIGHT_BOUNDS;
 	meshGeom.scale = PxMeshScale(GetScale());
-
-	// Create shape from the descriptor
-	pPxShape = PxRigidActorExt::createExclusiveShape(*pPxActor, meshGeom, *PxManager::GetInstance().GetMaterial());
-	pPxShape->setName(GetName().c_str());
+	return meshGeom;
 }
 
 //---------------------------------------
@@ -139,20 +136,24 @@ void PxMeshConvex::X_CreateShape()
 //---------------------------------------
 void PxMeshConvex::X_CreateMesh()
 {
-	// Cook / load mesh (only first instance)
-	X_CookMesh();
+	// Cook / load mesh (shared between instances)
+	bool created = X_CookMesh();
+
+	// Cooking failed
+	if (!pPxMesh)
+		return;
 
 #if PX_EXTRACT_INTERNAL
-	// Export cooked mesh to file (if first instance)
-	if (firstInstance)
+	// Export cooked mesh to file (if newly created)
+	if (created)
 	{
 		X_ExtractMesh();
 	}
 #endif // PX_EXTRACT_INTERNAL
 
 #if EXPORT_TO_FILE
-	// Store to obj file (if first instance)
-	if (firstInstance)
+	// Store to obj file (if newly created)
+	if (created)
 	{
 		X_StoreFile("_px");
 	}
@@ -182,6 +183,8 @@ PxMeshConvex::PxMeshConvex(const PxMeshConvex& copy) :
 	PxMesh(copy),
 	pPxMesh(copy.pPxMesh)
 {
+	// Copies share the cooked mesh
+	PxManager::GetInstance().GetMeshRegistry()->AddReference(pPxMesh);
 }
 
 //---------------------------------------
@@ -198,9 +201,10 @@ PxMeshConvex::PxMeshConvex(PxMeshConvex&& other) :
 //---------------------------------------
 PxMeshConvex::~PxMeshConvex()
 {
-	// Release mesh if this is the first instance
-	if (firstInstance)
+	// Released with the last instance using it
+	if (pPxMesh)
 	{
-		PX_RELEASE(pPxMesh);
+		PxManager::GetInstance().GetMeshRegistry()->Release(pPxMesh);
+		pPxMesh = NULL;
 	}
 }
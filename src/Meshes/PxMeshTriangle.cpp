@@ -11,56 +11,61 @@ bool PxMeshTriangle::X_IsStatic()
 }
 
 //---------------------------------------
-// Cooks or loads a mesh
+// Cooks or loads a mesh, true if newly created
 //---------------------------------------
-void PxMeshTriangle::X_CookMesh()
+bool PxMeshTriangle::X_CookMesh()
 {
 	// Return if mesh already loaded
 	if (pPxMesh)
-		return;
-
-	// Path to cooked mesh
-	ModifiablePath cookPath(meshPath); cookPath.concat("px");
-	// If cooked mesh not on disk
-	if (!boost::filesystem::exists(cookPath))
-	{
-		// Load mesh file
-		X_LoadFile();
-
-		// Create triangle mesh object
-		PxTriangleMeshDesc triangleDesc;
-		triangleDesc.points.count = vecVertices.size() / 3;
-		triangleDesc.points.stride = sizeof(float) * 3;
-		triangleDesc.points.data = X_GetVertices();
-		triangleDesc.triangles.count = vecIndices.size() / 3;
-		triangleDesc.triangles.stride = sizeof(int) * 3;
-		triangleDesc.triangles.data = X_GetIndices();
-
-		// Cook the mesh
+		return false;
+
+	// Flags & simplification change the cooked mesh, part of the registry key
+	PxMeshFlags meshFlags;
+	uint32_t errorBits;
+	std::memcpy(&errorBits, &simplifyError, sizeof(errorBits));
+	uint64_t cookHash = (static_cast<uint64_t>(errorBits) << 16) | static_cast<PxU16>(meshFlags);
+
+	// Shared with every other instance of the file, only cooked if not cached
+	bool created = false;
+	pPxMesh = PxManager::GetInstance().GetMeshRegistry()->AcquireTriangle(GetMeshPath().string(), cookHash,
+		[&](PxOutputStream& cookBuffer)
+		{
+			// Load mesh file, only positions are cooked
+			X_LoadFile();
+
+			// Collision proxy, the render mesh is loaded separately
+			size_t fullCount = vecIndices.size() / 3;
+			if (ComputeSimplifiedMesh(vecVertices, vecIndices, simplifyError))
+			{
+				vecNormals.clear();
+				vecUVs.clear();
+				std::cout << "\33[2K\r" << GetName() << " simplified:\t" << fullCount << " -> " << vecIndices.size() / 3 << " triangles" << std::endl;
+			}
+
+			// Create triangle mesh object
+			PxTriangleMeshDesc triangleDesc;
+			triangleDesc.points.count = vecVertices.size() / 3;
+			triangleDesc.points.stride = sizeof(float) * 3;
+			triangleDesc.points.data = X_GetVertices();
+			triangleDesc.triangles.count = vecIndices.size() / 3;
+			triangleDesc.triangles.stride = sizeof(int) * 3;
+			triangleDesc.triangles.data = X_GetIndices();
+			triangleDesc.flags = meshFlags;
+
+			// Cook the mesh into memory
 #pragma warning(disable:26812)
-		PxTriangleMeshCookingResult::Enum result;
+			PxTriangleMeshCookingResult::Enum result;
 #pragma warning(default:26812)
-		PxDefaultFileOutputStream writeOutBuffer(cookPath.string().c_str());
-		if (!PxManager::GetInstance().GetCooker()->cookTriangleMesh(triangleDesc, writeOutBuffer, &result))
-		{
-			std::cout << "\33[2K\r" << GetName() << " cooking error:\t" << result << std::endl;
-		}
-		else
-		{
-			std::cout << "\33[2K\r" << GetName() << " cooked to:\t" << boost::filesystem::relative(cookPath) << std::flush;
-		}
-	}
-	else
-	{
-		std::cout << "\33[2K\r" << GetName() << " loaded from:\t" << boost::filesystem::relative(cookPath) << std::flush;
-	}
-
-	// Create buffer
-	PxDefaultFileInputData readInBuffer(cookPath.string().c_str());
-	// Create the mesh from buffer
-	pPxMesh = PxGetPhysics().createTriangleMesh(readInBuffer);
-	// This mesh has to release the mesh
-	firstInstance = true;
+			if (!PxManager::GetInstance().GetCooker()->cookTriangleMesh(triangleDesc, cookBuffer, &result))
+			{
+				std::cout << "\33[2K\r" << GetName() << " cooking error:\t" << result << std::endl;
+				return false;
+			}
+			return true;
+		},
+		created
+	);
+	return created;
 }
 
 //---------------------------------------
@@ -106,20 +111,24 @@ void PxMeshTriangle::X_ExtractMesh()
 //---------------------------------------
 void PxMeshTriangle::X_CreateMesh()
 {
-	// Cook / load mesh (only first instance)
-	X_CookMesh();
+	// Cook / load mesh (shared between instances)
+	bool created = X_CookMesh();
+
+	// Cooking failed
+	if (!pPxMesh)
+		return;
 
 #if PX_EXTRACT_INTERNAL
-	// Export cooked mesh to file (if first instance)
-	if (firstInstance)
+	// Export cooked mesh to file (if newly created)
+	if (created)
 	{
 		X_ExtractMesh();
 	}
 #endif // PX_EXTRACT_INTERNAL
 
 #if EXPORT_TO_FILE
-	// Store to obj file (if first instance)
-	if (firstInstance)
+	// Store to obj file (if newly created)
+	if (created)
 	{
 		X_StoreFile("_px");
 	}
@@ -167,15 +176,19 @@ PxMeshTriangle::PxMeshTriangle(
 //---------------------------------------
 PxMeshTriangle::PxMeshTriangle(const PxMeshTriangle& copy) :
 	PxMesh(copy),
-	pPxMesh(copy.pPxMesh)
+	pPxMesh(copy.pPxMesh),
+	simplifyError(copy.simplifyError)
 {
+	// Copies share the cooked mesh
+	PxManager::GetInstance().GetMeshRegistry()->AddReference(pPxMesh);
 }
 
 //---------------------------------------
 // Move constructor
 //---------------------------------------
 PxMeshTriangle::PxMeshTriangle(PxMeshTriangle&& other) :
-	PxMesh(std::move(other))
+	PxMesh(std::move(other)),
+	simplifyError(other.simplifyError)
 {
 	pPxMesh = std::exchange(other.pPxMesh, nullptr);
 }
@@ -185,9 +198,10 @@ PxMeshTriangle::PxMeshTriangle(PxMeshTriangle&& other) :
 //---------------------------------------
 PxMeshTriangle::~PxMeshTriangle()
 {
-	// Release mesh if this is the first instance
-	if (firstInstance)
+	// Released with the last instance using it
+	if (pPxMesh)
 	{
-		PX_RELEASE(pPxMesh);
+		PxManager::GetInstance().GetMeshRegistry()->Release(pPxMesh);
+		pPxMesh = NULL;
 	}
 }
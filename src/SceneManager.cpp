@@ -6,6 +6,14 @@
 
 #define USE_AO 1
 #define USE_ESTIMATOR 1
+#define USE_CROP 1
+
+// Pixels rendered around the objects
+#define CROP_PADDING 8
+
+// Low resolution AO filter radius & relative depth tolerance
+#define AO_FILTER_RADIUS 2
+#define AO_DEPTH_SIGMA 0.02f
 
 #define PTR_RELEASE(x) if(x != NULL) { delete x; x = NULL; }
 
@@ -39,6 +47,7 @@ PxMeshTriangle SceneManager::X_PxCreateSceneMesh() const
 	meshPath.append(sceneMesh);
 	// Create physx mesh of scan scene
 	PxMeshTriangle pxMeshScene(meshPath, "scene", 0);
+	pxMeshScene.SetSimplifyError(renderSettings.GetSimulationSettings().CollisionError / toMeters);
 	pxMeshScene.CreateMesh();
 	pxMeshScene.SetObjId(0);
 	pxMeshScene.SetScale(PxVec3(toMeters));
@@ -58,30 +67,8 @@ physx::PxScene* SceneManager::X_PxCreateSimulation(
 	// For human readable depth: Maximal possible distance
 	maxDist = sceneMesh.GetGlobalBounds().getDimensions().magnitude();
 
-	// Standart gravity & continuous collision detection & GPU rigidbodies
-	PxSceneDesc sceneDesc(PxGetPhysics().getTolerancesScale());
-	sceneDesc.broadPhaseType = PxManager::GetInstance().GetCudaManager() ? PxBroadPhaseType::eGPU : PxBroadPhaseType::eABP;
-	sceneDesc.cpuDispatcher = PxDefaultCpuDispatcherCreate(std::thread::hardware_concurrency());
-	sceneDesc.cudaContextManager = PxManager::GetInstance().GetCudaManager();
-	sceneDesc.filterShader = PxManager::CCDFilterShader;
-	sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
-	sceneDesc.gpuMaxNumPartitions = 8;
-
-	// Enable GPU rigidbodies if available
-	if (PxManager::GetInstance().GetCudaManager())
-	{
-		sceneDesc.flags = PxSceneFlag::eENABLE_GPU_DYNAMICS | PxSceneFlag::eENABLE_STABILIZATION | PxSceneFlag::eENABLE_CCD | PxSceneFlag::eENABLE_PCM;
-	}
-	else
-	{
-		sceneDesc.flags = PxSceneFlag::eENABLE_STABILIZATION | PxSceneFlag::eENABLE_CCD | PxSceneFlag::eENABLE_PCM;
-	}
-
-	// Objects should never spawn outside the scene bounds
-	sceneDesc.sanityBounds = sceneMesh.GetGlobalBounds();
-
-	// Create scene & add mesh
-	PxScene* pCurrScene = PxGetPhysics().createScene(sceneDesc);
+	// Create scene with default options (CCD, PCM, stabilization, GPU if available) & add mesh
+	PxScene* pCurrScene = PxManager::GetInstance().CreateScene(sceneMesh.GetGlobalBounds(), PxSceneOptions());
 	sceneMesh.AddRigidActor(pCurrScene, sceneMesh.GetTransform());
 
 	// Return simulation
@@ -94,70 +81,35 @@ physx::PxScene* SceneManager::X_PxCreateSimulation(
 std::vector<PxMeshConvex> SceneManager::X_PxCreateObjs(
 	std::default_random_engine& generator,
 	PxMeshTriangle& sceneMesh,
-	physx::PxScene* simulation
+	physx::PxScene* simulation,
+	physx::PxU32 collisionGroup
 ) const
 {
-	// Helper lambdas
 	auto eigenToPx = [](Eigen::Vector3f in) -> PxVec3
 	{
 		return PxVec3(in.x(), in.y(), in.z());
 	};
-	auto uniformRandInt = [&](int lower, int upper) -> int
-	{
-		std::uniform_int_distribution<int> distr(lower, upper);
-		return distr(generator);
-	};
-	auto uniformRandVec = [&](PxVec3 lower, PxVec3 upper) -> PxVec3
-	{
-		std::uniform_real_distribution<float> distX(lower.x, upper.x);
-		std::uniform_real_distribution<float> distY(lower.y, upper.y);
-		std::uniform_real_distribution<float> distZ(lower.z, upper.z);
-		return PxVec3(distX(generator), distY(generator), distZ(generator));
-	};
-	auto applyForce = [&](float likelyhood) -> bool
-	{
-		std::bernoulli_distribution distr(likelyhood);
-		return distr(generator);
-	};
-
-	// Simulation objects
-	std::vector<PxMeshConvex> newBodies;
-	newBodies.reserve(renderSettings.GetSimulationSettings().SimulationObjects);
 
-	// Setup & fetch params
-	const PxVec3 sceneCenter = sceneMesh.GetGlobalBounds().getCenter();
-	const PxVec3 sceneExtends = sceneMesh.GetGlobalBounds().getExtents();
-	const PxVec3 spawnMin = eigenToPx(renderSettings.GetSpawnSettings().SpawnMin);
-	const PxVec3 spawnMax = eigenToPx(renderSettings.GetSpawnSettings().SpawnMax);
-	const PxVec3 velMax = eigenToPx(renderSettings.GetSpawnSettings().VelocityMax);
-	const PxVec3 trqMax = eigenToPx(renderSettings.GetSpawnSettings().TorqueMax);
+	// Spawn volume & forces from the config
+	PxSpawnOptions options;
+	options.SpawnMin = eigenToPx(renderSettings.GetSpawnSettings().SpawnMin);
+	options.SpawnMax = eigenToPx(renderSettings.GetSpawnSettings().SpawnMax);
+	options.VelocityMax = eigenToPx(renderSettings.GetSpawnSettings().VelocityMax);
+	options.TorqueMax = eigenToPx(renderSettings.GetSpawnSettings().TorqueMax);
+	options.ApplyProbability = renderSettings.GetSpawnSettings().ApplyProbability;
+	options.OverlapFree = renderSettings.GetSpawnSettings().SpawnMode == "overlap_free";
+	options.SpawnAttempts = renderSettings.GetSpawnSettings().SpawnAttempts;
+
+	// Same placement as the benchmark
+	PxSpawnStats stats;
+	std::vector<PxMeshConvex> newBodies = PxSpawnObjects(generator, vecpPxMeshObjs, sceneMesh, simulation,
+		renderSettings.GetSimulationSettings().SimulationObjects, options, collisionGroup, stats);
 
-	// For each object
-	for (int i = 0; i < renderSettings.GetSimulationSettings().SimulationObjects; ++i)
+	// Some status logging
+	if (options.OverlapFree)
 	{
-		// Fetch random object & create instance with new id
-		int randObj = uniformRandInt(0, vecpPxMeshObjs.size() - 1);
-		PxMeshConvex currObj(*vecpPxMeshObjs[randObj]);
-		currObj.SetObjId(i + 1);
-		currObj.CreateMesh();
-
-		// Random position in scene
-		PxVec3 randPos = sceneCenter +
-			uniformRandVec(spawnMin, spawnMax).multiply(sceneExtends);
-
-		// Set pose & actor
-		PxTransform pose(randPos, PxQuat(PxIdentity));
-		currObj.AddRigidActor(simulation, pose);
-
-		// Possibly add random velocity & torque impulses
-		if (applyForce(renderSettings.GetSpawnSettings().ApplyProbability))
-		{
-			currObj.AddVelocity(uniformRandVec(-velMax, velMax));
-			currObj.AddTorque(uniformRandVec(-trqMax, trqMax));
-		}
-
-		// Place in vector
-		newBodies.push_back(std::move(currObj));
+		std::cout << "\33[2K\r" << "Spawned " << newBodies.size() << " objects (" << stats.RejectedSamples
+			<< " samples rejected, " << stats.UnplacedObjects << " without free spot)" << std::endl;
 	}
 
 	// Return simulation objects
@@ -169,9 +121,7 @@ std::vector<PxMeshConvex> SceneManager::X_PxCreateObjs(
 //---------------------------------------
 void SceneManager::X_CleanupScene(
 	physx::PxScene* simulation,
-	AnnotationsManager* annotations,
-	Blender::BlenderRenderer* renderer,
-	int threadID
+	AnnotationsManager* annotations
 ) const
 {
 	// Cleanup annotations
@@ -181,59 +131,78 @@ void SceneManager::X_CleanupScene(
 	if (simulation)
 	{
 		simulation->flushSimulation();
-		auto dispatcher = (PxDefaultCpuDispatcher*)simulation->getCpuDispatcher();
-		PX_RELEASE(dispatcher);
+		auto dispatcher = static_cast<PxTaskPool::SceneDispatcher*>(simulation->getCpuDispatcher());
 		PX_RELEASE(simulation);
+		// Dispatcher is shared, only the scene's share is released
+		PX_RELEASE(dispatcher);
 	}
-
-	// Reload render process thread
-	renderer->UnloadProcess(threadID);
 }
 
 //---------------------------------------
-// Run physx simulation
+// Run physx simulation until settled
 //---------------------------------------
-void SceneManager::X_PxRunSim(
+int SceneManager::X_PxRunSim(
 	physx::PxScene* simulation,
 	float timestep,
 	int stepCount
 ) const
 {
-	// Simulate in steps
-	for (int i = 0; i < stepCount; ++i)
-	{
-		simulation->simulate(timestep);
-		simulation->fetchResults(true);
-	}
+	Settings::Simulation simSettings = renderSettings.GetSimulationSettings();
+
+	// Stop early once settled (if enabled)
+	PxSettleOptions settle;
+	settle.SettleSteps = simSettings.SettleSteps;
+	settle.SettleLinear = simSettings.SettleLinear;
+	settle.SettleAngular = simSettings.SettleAngular;
+	int steps = PxManager::RunSimulation(simulation, timestep, stepCount, settle);
 
 	// Some status logging
 	std::cout << "\33[2K\r" << "Done simulating (" << timestep << "s steps, "
-		<< timestep * stepCount << "s total)" << std::endl;
+		<< timestep * steps << "s total, " << steps << "/" << stepCount << " steps)" << std::endl;
+	return steps;
 }
 
 //---------------------------------------
 // Fetch and save simulation results
 //---------------------------------------
-std::vector<RenderMesh> SceneManager::X_PxSaveSimResults(
+std::vector<SceneManager::SimulatedObject> SceneManager::X_PxSaveSimResults(
 	std::vector<PxMeshConvex>& simulationObjs
 ) const
 {
-	std::vector<RenderMesh> newMeshes;
-	newMeshes.reserve(simulationObjs.size());
+	std::vector<SimulatedObject> simulatedObjs;
+	simulatedObjs.reserve(simulationObjs.size());
 
-	// For each physx object
+	// Only the final poses are needed for rendering
 	for (auto& currPx : simulationObjs)
+	{
+		simulatedObjs.push_back(SimulatedObject{ currPx.GetObjId(), currPx.GetMeshId(), currPx.GetTransform() });
+	}
+
+	return simulatedObjs;
+}
+
+//---------------------------------------
+// Create render meshes from simulated poses
+//---------------------------------------
+std::vector<RenderMesh> SceneManager::X_ConvertSimResults(
+	const std::vector<SimulatedObject>& simulatedObjs
+) const
+{
+	std::vector<RenderMesh> newMeshes;
+	newMeshes.reserve(simulatedObjs.size());
+
+	// For each simulated object
+	for (const auto& currObj : simulatedObjs)
 	{
 		// Get position & transform to Blender system (90* around X)
-		PxTransform pose = currPx.GetTransform();
-		PxTransform adjustPos = PxTransform(PxQuat(PxHalfPi, PxVec3(1.0f, 0.0f, 0.0f))).transform(pose);
+		PxTransform adjustPos = PxTransform(PxQuat(PxHalfPi, PxVec3(1.0f, 0.0f, 0.0f))).transform(currObj.Pose);
 		// Transform rotation to Blender system (-90* around local X)
 		PxVec3 localX = adjustPos.q.rotate(PxVec3(1.0f, 0.0f, 0.0f));
 		PxTransform adjustRot = PxTransform(PxQuat(-PxHalfPi, localX)).transform(adjustPos);
 
 		// Save & create mesh for rendering
-		RenderMesh currMesh(*vecpRenderMeshObjs[currPx.GetMeshId()]);
-		currMesh.SetObjId(currPx.GetObjId());
+		RenderMesh currMesh(*vecpRenderMeshObjs[currObj.MeshId]);
+		currMesh.SetObjId(currObj.ObjId);
 
 		// Build transform from simulated pose
 		Eigen::Affine3f currTrans;
@@ -252,11 +221,212 @@ std::vector<RenderMesh> SceneManager::X_PxSaveSimResults(
 	return newMeshes;
 }
 
+//---------------------------------------
+// Stored layout of a scene iteration
+//---------------------------------------
+ModifiablePath SceneManager::X_GetSimCachePath(
+	int iteration
+) const
+{
+	ModifiablePath cachePath(renderSettings.GetCachePath());
+	cachePath.append("simulations");
+	cachePath.append(renderSettings.GetScenePath().filename().string());
+	cachePath.append("iteration_" + FormatInt(iteration) + ".json");
+	return cachePath;
+}
+
+//---------------------------------------
+// Settings a stored layout depends on
+//---------------------------------------
+void SceneManager::X_AddSimParams(
+	JSONWriterRef writer
+) const
+{
+	const Settings::Simulation& simSettings = renderSettings.GetSimulationSettings();
+	const Settings::Spawning& spawnSettings = renderSettings.GetSpawnSettings();
+
+	writer.StartObject();
+
+	writer.Key("scene_mesh");
+	AddString(writer, SafeGet<const char*>(renderSettings.GetJSONConfig(), "scene_mesh"));
+	writer.Key("scene_unit");
+	AddFloat(writer, SafeGet<float>(renderSettings.GetJSONConfig(), "scene_unit"));
+	writer.Key("collision_error");
+	AddFloat(writer, simSettings.CollisionError);
+
+	writer.Key("simulation_objects");
+	writer.Int(simSettings.SimulationObjects);
+	writer.Key("simulation_steps");
+	writer.Int(simSettings.SimulationSteps);
+	writer.Key("settle_steps");
+	writer.Int(simSettings.SettleSteps);
+	writer.Key("settle_linear");
+	AddFloat(writer, simSettings.SettleLinear);
+	writer.Key("settle_angular");
+	AddFloat(writer, simSettings.SettleAngular);
+
+	writer.Key("spawn_min");
+	AddEigenVector(writer, spawnSettings.SpawnMin);
+	writer.Key("spawn_max");
+	AddEigenVector(writer, spawnSettings.SpawnMax);
+	writer.Key("velocity_max");
+	AddEigenVector(writer, spawnSettings.VelocityMax);
+	writer.Key("torque_max");
+	AddEigenVector(writer, spawnSettings.TorqueMax);
+	writer.Key("apply_probability");
+	AddFloat(writer, spawnSettings.ApplyProbability);
+	writer.Key("spawn_mode");
+	AddString(writer, spawnSettings.SpawnMode);
+	writer.Key("spawn_attempts");
+	writer.Int(spawnSettings.SpawnAttempts);
+
+	// Mesh ids refer to these objects
+	writer.Key("meshes");
+	writer.StartArray();
+	for (auto currMesh : vecpPxMeshObjs)
+	{
+		writer.StartObject();
+		writer.Key("name");
+		AddString(writer, currMesh->GetName());
+		writer.Key("scale");
+		AddFloat(writer, currMesh->GetScale().x);
+		writer.EndObject();
+	}
+	writer.EndArray();
+
+	writer.EndObject();
+}
+
+//---------------------------------------
+// Store simulated layout for later replays
+//---------------------------------------
+void SceneManager::X_StoreSimResults(
+	int iteration,
+	unsigned int seed,
+	int layout,
+	const std::vector<SimulatedObject>& simulatedObjs
+) const
+{
+	JSONRenderfileWriter writer;
+	writer.StartObject();
+
+	writer.Key("seed");
+	writer.Uint(seed);
+	writer.Key("layout");
+	writer.Int(layout);
+	writer.Key("params");
+	X_AddSimParams(writer);
+
+	// Poses in physx system, converted when replayed
+	writer.Key("objects");
+	writer.StartArray();
+	for (const auto& currObj : simulatedObjs)
+	{
+		writer.StartObject();
+		writer.Key("obj_id");
+		writer.Int(currObj.ObjId);
+		writer.Key("mesh_id");
+		writer.Int(currObj.MeshId);
+		writer.Key("position");
+		AddEigenVector(writer, Eigen::Vector3f(currObj.Pose.p.x, currObj.Pose.p.y, currObj.Pose.p.z));
+		writer.Key("rotation");
+		AddEigenVector(writer, Eigen::Vector4f(currObj.Pose.q.x, currObj.Pose.q.y, currObj.Pose.q.z, currObj.Pose.q.w));
+		writer.EndObject();
+	}
+	writer.EndArray();
+
+	writer.EndObject();
+
+	// Written to a temporary file first, so replays never read partial layouts
+	ModifiablePath cachePath(X_GetSimCachePath(iteration));
+	ModifiablePath tempPath(cachePath);
+	tempPath.concat(".tmp");
+	boost::system::error_code error;
+	boost::filesystem::create_directories(cachePath.parent_path(), error);
+	{
+		std::string layoutFile(writer.GetRenderfile());
+		std::ofstream file(tempPath.string(), std::ios::trunc);
+		if (!file.write(layoutFile.c_str(), layoutFile.size()))
+		{
+			std::cout << "Could not store simulation: " << tempPath << std::endl;
+			return;
+		}
+	}
+	boost::filesystem::rename(tempPath, cachePath, error);
+	if (error)
+	{
+		std::cout << "Could not store simulation: " << cachePath << " (" << error.message() << ")" << std::endl;
+		boost::filesystem::remove(tempPath, error);
+	}
+}
+
+//---------------------------------------
+// Load stored layout, if it matches the current settings
+//---------------------------------------
+bool SceneManager::X_LoadSimResults(
+	int iteration,
+	std::vector<SimulatedObject>& simulatedObjs
+) const
+{
+	ModifiablePath cachePath(X_GetSimCachePath(iteration));
+	if (!boost::filesystem::exists(cachePath))
+		return false;
+
+	rapidjson::Document layoutDoc;
+	if (!CanReadJSONFile(cachePath, layoutDoc))
+		return false;
+
+	// Settings are compared the way they were stored
+	JSONRenderfileWriter paramsWriter;
+	X_AddSimParams(paramsWriter);
+	rapidjson::Document currParams;
+	currParams.Parse(paramsWriter.GetRenderfile().c_str());
+	const rapidjson::Value* storedParams;
+	if (!SafeHasMember(layoutDoc, "params", storedParams) || *storedParams != currParams)
+	{
+		std::cout << "Stored simulation " << cachePath << " is outdated, simulating again" << std::endl;
+		return false;
+	}
+
+	const rapidjson::Value* storedObjs;
+	if (!SafeHasMember(layoutDoc, "objects", storedObjs) || !storedObjs->IsArray())
+		return false;
+
+	simulatedObjs.clear();
+	for (const auto& currObj : storedObjs->GetArray())
+	{
+		const rapidjson::Value* position;
+		const rapidjson::Value* rotation;
+		int meshId = SafeGet<int>(currObj, "mesh_id");
+		if (meshId < 0 || meshId >= static_cast<int>(vecpRenderMeshObjs.size()) ||
+			!SafeHasMember(currObj, "position", position) || !position->IsArray() || position->Size() != 3 ||
+			!SafeHasMember(currObj, "rotation", rotation) || !rotation->IsArray() || rotation->Size() != 4)
+		{
+			std::cout << "Stored simulation " << cachePath << " is invalid, simulating again" << std::endl;
+			simulatedObjs.clear();
+			return false;
+		}
+		Eigen::Vector3f pos = SafeGetEigenVector<Eigen::Vector3f>(*position);
+		Eigen::Vector4f rot = SafeGetEigenVector<Eigen::Vector4f>(*rotation);
+		simulatedObjs.push_back(SimulatedObject{
+			SafeGet<int>(currObj, "obj_id"),
+			meshId,
+			PxTransform(PxVec3(pos.x(), pos.y(), pos.z()), PxQuat(rot.x(), rot.y(), rot.z(), rot.w()))
+		});
+	}
+
+	std::cout << "Replaying stored simulation " << cachePath << " (seed "
+		<< SafeGet<unsigned int>(layoutDoc, "seed") << ")" << std::endl;
+	return true;
+}
+
 //---------------------------------------
 // Adds provided scene to renderfile
 //---------------------------------------
 void SceneManager::X_ConvertToRenderfile(
 	JSONWriterRef writer,
+	RenderfileTracker& tracker,
+	RenderMesh* sceneMesh,
 	std::vector<RenderMesh>& meshes,
 	std::vector<Camera>& cams,
 	std::vector<Light>& lights
@@ -264,34 +434,54 @@ void SceneManager::X_ConvertToRenderfile(
 {
 	writer.StartObject();
 
+	// Only send changes if the worker already holds the scene
+	bool isDelta = tracker.BeginUpdate();
+	writer.Key("delta");
+	writer.Bool(isDelta);
+
 	// Add settings
 	writer.Key("settings");
 	renderSettings.AddToJSON(writer);
 
-	// Add provided cameras
+	// Add provided cameras, always listed since they are rendered
 	writer.Key("cameras");
 	writer.StartArray();
 	for (auto& currCam : cams)
 	{
-		currCam.AddToJSON(writer);
+		tracker.Write(writer, "cameras", "cameraID", currCam.GetImageNum(), currCam, true);
 	}
 	writer.EndArray();
 
-	// Add provided meshes
+	// Add new meshes & changed members (e.g. only the shader) of existing ones
 	writer.Key("meshes");
 	writer.StartArray();
 	for (auto& currMesh : meshes)
 	{
-		currMesh.AddToJSON(writer);
+		tracker.Write(writer, "meshes", "objectID", currMesh.GetObjId(), currMesh, false);
+	}
+	// Scene is added last, if part of this pass
+	if (sceneMesh)
+	{
+		tracker.Write(writer, "meshes", "objectID", sceneMesh->GetObjId(), *sceneMesh, false);
 	}
 	writer.EndArray();
 
-	// Add lights
+	// Add lights, always listed so removed ones are noticed
 	writer.Key("lights");
 	writer.StartArray();
-	for (auto& currLight : lights)
+	for (int curr = 0; curr < lights.size(); ++curr)
 	{
-		currLight.AddToJSON(writer);
+		tracker.Write(writer, "lights", "lightID", curr, lights[curr], true);
+	}
+	writer.EndArray();
+
+	// Add meshes the worker should remove
+	tracker.EndUpdate();
+	writer.Key("removed");
+	writer.StartArray();
+	for (int removedID : tracker.GetRemoved("meshes"))
+	{
+		writer.Int(removedID);
 	}
 	writer.EndArray();
 
@@ -303,6 +493,7 @@ void SceneManager::X_ConvertToRenderfile(
 //---------------------------------------
 void SceneManager::X_BuildSceneDepth(
 	JSONWriterRef writer,
+	RenderfileTracker& tracker,
 	RenderMesh& sceneMesh,
 	std::vector<RenderMesh>& meshes,
 	std::vector<Camera>& cams,
@@ -362,8 +553,8 @@ void SceneManager::X_BuildSceneDepth(
 	if (toRender.size() > 0)
 	{
 		// Add configured scene to renderfile
-		std::vector<RenderMesh> scene = { sceneMesh };
-		X_ConvertToRenderfile(writer, scene, toRender, lights);
+		std::vector<RenderMesh> noObjects;
+		X_ConvertToRenderfile(writer, tracker, &sceneMesh, noObjects, toRender, lights);
 	}
 
 	// Mark indirect again
@@ -375,6 +566,7 @@ void SceneManager::X_BuildSceneDepth(
 //---------------------------------------
 void SceneManager::X_BuildObjectsDepth(
 	JSONWriterRef writer,
+	RenderfileTracker& tracker,
 	RenderMesh& sceneMesh,
 	std::vector<RenderMesh>& meshes,
 	std::vector<Camera>& cams,
@@ -407,15 +599,15 @@ void SceneManager::X_BuildObjectsDepth(
 		results.emplace_back(std::move(currDepth));
 	}
 
-	// Set shaders
+	// Set shaders, all objects share one
+	auto depthShader = std::make_shared<DepthShader>(FLT_EPSILON, maxDist);
 	for (auto& currMesh : meshes)
 	{
-		DepthShader* currShader = new DepthShader(FLT_EPSILON, maxDist);
-		currMesh.SetShader(currShader);
+		currMesh.SetShader(depthShader);
 	}
 
 	// Add configured scene to renderfile
-	X_ConvertToRenderfile(writer, meshes, cams, lights);
+	X_ConvertToRenderfile(writer, tracker, NULL, meshes, cams, lights);
 }
 
 //---------------------------------------
@@ -423,6 +615,7 @@ void SceneManager::X_BuildObjectsDepth(
 //---------------------------------------
 void SceneManager::X_BuildObjectsLabel(
 	JSONWriterRef writer,
+	RenderfileTracker& tracker,
 	RenderMesh& sceneMesh,
 	std::vector<RenderMesh>& meshes,
 	std::vector<Camera>& cams,
@@ -463,7 +656,7 @@ void SceneManager::X_BuildObjectsLabel(
 	}
 
 	// Add configured scene to renderfile
-	X_ConvertToRenderfile(writer, meshes, cams, lights);
+	X_ConvertToRenderfile(writer, tracker, NULL, meshes, cams, lights);
 }
 
 //---------------------------------------
@@ -471,6 +664,7 @@ void SceneManager::X_BuildObjectsLabel(
 //---------------------------------------
 void SceneManager::X_BuildObjectsPBR(
 	JSONWriterRef writer,
+	RenderfileTracker& tracker,
 	RenderMesh& sceneMesh,
 	std::vector<RenderMesh>& meshes,
 	std::vector<Camera>& cams,
@@ -493,56 +687,27 @@ void SceneManager::X_BuildObjectsPBR(
 			currPBR.GetPath(),
 			renderRes,
 			false,
-			4,
+			renderSettings.GetEngineSettings().PBRSamples,
 			-1,
 			"",
 #if USE_ESTIMATOR
-			true
+			true,
 #else
-			false
+			false,
 #endif
+			USE_CROP
 		);
+		// Denoised in C++ instead
+		cams[curr].SetDenoise(!renderSettings.GetEngineSettings().Denoise);
 		// Place in output vector
 		results.emplace_back(std::move(currPBR));
 	}
 
 	// Set shaders
-	for (auto& currMesh : meshes)
-	{
-		// Test metal shader?
-		if(currMesh.GetShaderType() == "metal")
-		{
-			MetalShader* currShader = new MetalShader();
-			currMesh.SetShader(currShader);
-		}
-		// Test glass shader?
-		else if (currMesh.GetShaderType() == "glass")
-		{
-			GlassShader* currShader = new GlassShader();
-			currMesh.SetShader(currShader);
-		}
-		// Otherwise PBR
-		else
-		{
-			// Create diffuse texture
-			Texture currDiffuse;
-			currDiffuse.SetPath(currMesh.GetTexturePath(), false);
-			// Set PBR shader
-			PBRShader* currShader = new PBRShader(currDiffuse);
-			currMesh.SetShader(currShader);
-		}
-	}
-
-	// Setup scene for indirect light & shadows
-	Texture diffuseScene;
-	diffuseScene.SetPath(renderSettings.GetScenePath() / "mesh.refined_0.png", false);
-	PBRShader* scenePBR = new PBRShader(diffuseScene);
-	sceneMesh.SetShader(scenePBR);
+	X_SetPBRShaders(sceneMesh, meshes);
 
 	// Add configured scene to renderfile
-	meshes.push_back(sceneMesh);
-	X_ConvertToRenderfile(writer, meshes, cams, lights);
-	meshes.pop_back();
+	X_ConvertToRenderfile(writer, tracker, &sceneMesh, meshes, cams, lights);
 }
 
 //---------------------------------------
@@ -550,6 +715,7 @@ void SceneManager::X_BuildObjectsPBR(
 //---------------------------------------
 void SceneManager::X_BuildObjectsAO(
 	JSONWriterRef writer,
+	RenderfileTracker& tracker,
 	RenderMesh& sceneMesh,
 	std::vector<RenderMesh>& meshes,
 	std::vector<Camera>& cams,
@@ -557,9 +723,10 @@ void SceneManager::X_BuildObjectsAO(
 	std::vector<Texture>& results
 ) const
 {
-	// Determine render resolution
+	// Determine render resolution (AO may be lower)
 	Eigen::Vector2i renderRes = camBlueprint.GetIntrinsics().GetResolution();
 	renderRes *= renderSettings.GetEngineSettings().RenderScale;
+	renderRes = (renderRes.cast<float>() * renderSettings.GetEngineSettings().AOScale).cast<int>();
 
 	// For every pose
 	for (int curr = 0; curr < cams.size(); ++curr)
@@ -575,23 +742,123 @@ void SceneManager::X_BuildObjectsAO(
 			2,
 			-1,
 			"ambient_occlusion",
-			false
+			false,
+			USE_CROP
 		);
 		// Place in output vector
 		results.emplace_back(std::move(currAO));
 	}
 
 	// Add configured scene to renderfile
-	meshes.push_back(sceneMesh);
-	X_ConvertToRenderfile(writer, meshes, cams, lights);
-	meshes.pop_back();
+	X_ConvertToRenderfile(writer, tracker, &sceneMesh, meshes, cams, lights);
+}
+
+//---------------------------------------
+// Build objects denoising feature renderfile
+//---------------------------------------
+void SceneManager::X_BuildObjectsFeature(
+	JSONWriterRef writer,
+	RenderfileTracker& tracker,
+	RenderMesh& sceneMesh,
+	std::vector<RenderMesh>& meshes,
+	std::vector<Camera>& cams,
+	std::vector<Light>& lights,
+	std::vector<Texture>& results,
+	const std::string& feature
+) const
+{
+	// Determine render resolution
+	Eigen::Vector2i renderRes = camBlueprint.GetIntrinsics().GetResolution();
+	renderRes *= renderSettings.GetEngineSettings().RenderScale;
+
+	// For every pose
+	for (int curr = 0; curr < cams.size(); ++curr)
+	{
+		// Create feature output texture
+		Texture currFeature(true, false);
+		currFeature.SetPath(renderSettings.GetImagePath("body_" + feature, cams[curr].GetImageNum()), false, "exr");
+		// Setup rendering params
+		cams[curr].SetupRendering(
+			currFeature.GetPath(),
+			renderRes,
+			true,
+			1,
+			0,
+			feature,
+			false,
+			USE_CROP
+		);
+		// Place in output vector
+		results.emplace_back(std::move(currFeature));
+	}
+
+	// Albedo needs the actual materials
+	X_SetPBRShaders(sceneMesh, meshes);
+
+	// Add configured scene to renderfile
+	X_ConvertToRenderfile(writer, tracker, &sceneMesh, meshes, cams, lights);
+}
+
+//---------------------------------------
+// Set shaders used for PBR rendering
+//---------------------------------------
+void SceneManager::X_SetPBRShaders(
+	RenderMesh& sceneMesh,
+	std::vector<RenderMesh>& meshes
+) const
+{
+	// Instances of the same object share their shader
+	std::shared_ptr<const OSLShader> metalShader, glassShader;
+	std::vector<std::shared_ptr<const OSLShader>> pbrShaders(vecpRenderMeshObjs.size());
+	for (auto& currMesh : meshes)
+	{
+		// Test metal shader?
+		if(currMesh.GetShaderType() == "metal")
+		{
+			if (!metalShader)
+				metalShader = std::make_shared<MetalShader>();
+			currMesh.SetShader(metalShader);
+		}
+		// Test glass shader?
+		else if (currMesh.GetShaderType() == "glass")
+		{
+			if (!glassShader)
+				glassShader = std::make_shared<GlassShader>();
+			currMesh.SetShader(glassShader);
+		}
+		// Otherwise PBR
+		else
+		{
+			// Created for the first instance of each object
+			int meshId = currMesh.GetMeshId();
+			bool isShared = meshId >= 0 && meshId < static_cast<int>(pbrShaders.size());
+			std::shared_ptr<const OSLShader> currShader = isShared ? pbrShaders[meshId] : nullptr;
+			if (!currShader)
+			{
+				// Create diffuse texture
+				Texture currDiffuse;
+				currDiffuse.SetPath(currMesh.GetTexturePath(), false);
+				// Create PBR shader
+				currShader = std::make_shared<PBRShader>(currDiffuse);
+				if (isShared)
+					pbrShaders[meshId] = currShader;
+			}
+			currMesh.SetShader(currShader);
+		}
+	}
+
+	// Setup scene for indirect light & shadows
+	Texture diffuseScene;
+	diffuseScene.SetPath(renderSettings.GetScenePath() / "mesh.refined_0.png", false);
+	PBRShader* scenePBR = new PBRShader(diffuseScene);
+	sceneMesh.SetShader(scenePBR);
 }
 
 //---------------------------------------
 // Render coverage masks & depths
 //---------------------------------------
 std::vector<Mask> SceneManager::X_RenderDepthMasks(
-	Blender::BlenderRenderer* renderer,
+	RenderPool* pool,
 	int threadID,
 	RenderMesh& sceneMesh,
 	std::vector<RenderMesh>& meshes,
@@ -610,7 +877,11 @@ std::vector<Mask> SceneManager::X_RenderDepthMasks(
 	// Only one thread at a time renders scene depth
 	syncPoint->lock();
 
-	RENDERFILE_DEPTH(renderer, threadID, X_BuildSceneDepth, sceneMesh, meshes, cams, lights, sceneDepths, maxDist);
+	RenderJob sceneDepthJob(*pool, threadID, "scene_depth", cams, sceneDepths,
+		[&](JSONWriterRef writer, RenderfileTracker& tracker, std::vector<Camera>& toRender, std::vector<Texture>& results) {
+			X_BuildSceneDepth(writer, tracker, sceneMesh, meshes, toRender, lights, results, maxDist);
+		});
+	sceneDepthJob.Wait();
 
 	// For every pose
 	for (int curr = 0; curr < cams.size(); ++curr)
@@ -633,7 +904,11 @@ std::vector<Mask> SceneManager::X_RenderDepthMasks(
 	syncPoint->unlock();
 
 	// Create & process renderfile
-	RENDERFILE_DEPTH(renderer, threadID, X_BuildObjectsDepth, sceneMesh, meshes, cams, lights, objectDepths, maxDist);
+	RenderJob objectDepthJob(*pool, threadID, "object_depth", cams, objectDepths,
+		[&](JSONWriterRef writer, RenderfileTracker& tracker, std::vector<Camera>& toRender, std::vector<Texture>& results) {
+			X_BuildObjectsDepth(writer, tracker, sceneMesh, meshes, toRender, lights, results, maxDist);
+		});
+	objectDepthJob.Wait();
 
 	// For every pose
 	for (int curr = 0; curr < cams.size(); ++curr)
@@ -668,56 +943,118 @@ std::vector<Mask> SceneManager::X_RenderDepthMasks(
 }
 
 //---------------------------------------
-// Render segments & create annotations
+// Submit label, AO & PBR renders of a batch
 //---------------------------------------
-void SceneManager::X_RenderSegments(
-	Blender::BlenderRenderer* renderer,
+std::unique_ptr<SceneManager::PendingBatch> SceneManager::X_SubmitBatch(
+	RenderPool* pool,
 	int threadID,
-	AnnotationsManager* annotations,
 	RenderMesh& sceneMesh,
 	std::vector<RenderMesh>& meshes,
-	std::vector<Camera>& cams,
 	std::vector<Light>& lights,
-	std::vector<Mask>& masks
+	std::vector<Camera>&& cams,
+	std::vector<Mask>&& masks,
+	std::vector<SceneImage>&& sceneRGBs
 ) const
 {
-	// Initialize output vector
-	std::vector<Texture> objectLabels;
-	objectLabels.reserve(cams.size());
+	// Batch owns everything the renders refer to
+	std::unique_ptr<PendingBatch> batch(new PendingBatch());
+	batch->Cams = std::move(cams);
+	batch->Masks = std::move(masks);
+	batch->Images = std::move(sceneRGBs);
+
+	// Only pixels around the objects are blended, so only those are rendered
+	for (int curr = 0; curr < batch->Cams.size(); ++curr)
+	{
+		const cv::Mat& mask = batch->Masks[curr].GetTexture();
+		cv::Rect crop = ComputeCropWindow(mask, CROP_PADDING);
+		batch->Cams[curr].SetCropWindow(Eigen::Vector4i(crop.x, crop.y, crop.width, crop.height), Eigen::Vector2i(mask.cols, mask.rows));
+	}
 
-	// Create & process renderfile
-	RENDERFILE_SINGLE(renderer, threadID, X_BuildObjectsLabel, sceneMesh, meshes, cams, lights, objectLabels);
+	// Create & submit label renderfile
+	batch->LabelJob.reset(new RenderJob(*pool, threadID, "label", batch->Cams, batch->Labels,
+		[this, &sceneMesh, &meshes, &lights](JSONWriterRef writer, RenderfileTracker& tracker, std::vector<Camera>& toRender, std::vector<Texture>& results) {
+			X_BuildObjectsLabel(writer, tracker, sceneMesh, meshes, toRender, lights, results);
+		}));
+
+	// Create & submit ambient occlusion renderfile
+#if USE_AO
+	batch->AOJob.reset(new RenderJob(*pool, threadID, "ao", batch->Cams, batch->AOs,
+		[this, &sceneMesh, &meshes, &lights](JSONWriterRef writer, RenderfileTracker& tracker, std::vector<Camera>& toRender, std::vector<Texture>& results) {
+			X_BuildObjectsAO(writer, tracker, sceneMesh, meshes, toRender, lights, results);
+		}));
+#else
+	batch->AOs.assign(batch->Cams.size(), Texture(false, false));
+#endif
+
+	// Create & submit PBR renderfile
+	batch->PBRJob.reset(new RenderJob(*pool, threadID, "pbr", batch->Cams, batch->PBRs,
+		[this, &sceneMesh, &meshes, &lights](JSONWriterRef writer, RenderfileTracker& tracker, std::vector<Camera>& toRender, std::vector<Texture>& results) {
+			X_BuildObjectsPBR(writer, tracker, sceneMesh, meshes, toRender, lights, results);
+		}));
+
+	// Create & submit denoising feature renderfiles
+#if USE_OIDN
+	if (renderSettings.GetEngineSettings().Denoise)
+	{
+		batch->AlbedoJob.reset(new RenderJob(*pool, threadID, "albedo", batch->Cams, batch->Albedos,
+			[this, &sceneMesh, &meshes, &lights](JSONWriterRef writer, RenderfileTracker& tracker, std::vector<Camera>& toRender, std::vector<Texture>& results) {
+				X_BuildObjectsFeature(writer, tracker, sceneMesh, meshes, toRender, lights, results, "albedo");
+			}));
+		batch->NormalJob.reset(new RenderJob(*pool, threadID, "normal", batch->Cams, batch->Normals,
+			[this, &sceneMesh, &meshes, &lights](JSONWriterRef writer, RenderfileTracker& tracker, std::vector<Camera>& toRender, std::vector<Texture>& results) {
+				X_BuildObjectsFeature(writer, tracker, sceneMesh, meshes, toRender, lights, results, "shading_normal");
+			}));
+	}
+#endif //USE_OIDN
+
+	return batch;
+}
+
+//---------------------------------------
+// Create segments & annotations
+//---------------------------------------
+void SceneManager::X_RenderSegments(
+	AnnotationsManager* annotations,
+	std::vector<RenderMesh>& meshes,
+	PendingBatch& batch
+) const
+{
+	// Labels have to be rendered
+	batch.LabelJob->Wait();
 
 	// For every pose
-	for (int curr = 0; curr < cams.size(); ++curr)
+	for (int curr = 0; curr < batch.Cams.size(); ++curr)
 	{
 		// Load & unpack label texture
-		objectLabels[curr].LoadTexture(UnpackLabel);
-		objectLabels[curr].ReplacePacked();
+		batch.Labels[curr].LoadTexture(UnpackLabel);
+		batch.Labels[curr].ReplacePacked();
 #if STORE_DEBUG_TEX
-		objectLabels[curr].StoreTexture();
+		batch.Labels[curr].StoreTexture();
 #endif //STORE_DEBUG_TEX
 
 		// Sanity check
-		if (!objectLabels[curr].TextureExists() || !masks[curr].TextureExists())
+		if (!batch.Labels[curr].TextureExists() || !batch.Masks[curr].TextureExists())
+		{
+			pOutputSink->Discard(batch.Cams[curr].GetImageNum());
 			continue;
+		}
 
 		// Create & store masked segmentation texture
 		Texture segResult(false, true);
-		segResult.SetPath(renderSettings.GetImagePath("segs", cams[curr].GetImageNum(), true), false);
-		segResult.SetTexture(ComputeSegmentMask(objectLabels[curr].GetTexture(), masks[curr].GetTexture()));
-		segResult.StoreTexture();
+		segResult.SetPath(renderSettings.GetImagePath("segs", batch.Cams[curr].GetImageNum(), true), false);
+		segResult.SetTexture(ComputeSegmentMask(batch.Labels[curr].GetTexture(), batch.Masks[curr].GetTexture()));
+		segResult.StoreTexture(*pOutputSink, batch.Cams[curr].GetImageNum());
 
 		// Create annotation file
-		annotations->Begin(cams[curr].GetImageNum());
+		annotations->Begin(batch.Cams[curr].GetImageNum());
 		// Add all visible objects
 		for (auto& currMesh : meshes)
 		{
 			annotations->Write(
 				currMesh,
-				objectLabels[curr].GetTexture(),
+				batch.Labels[curr].GetTexture(),
 				segResult.GetTexture(),
-				cams[curr]
+				batch.Cams[curr]
 			);
 		}
 		// Store & close
@@ -726,66 +1063,161 @@ void SceneManager::X_RenderSegments(
 }
 
 //---------------------------------------
-// Render synthetic objects & create blend
+// Blend synthetic objects with real image
 //---------------------------------------
 void SceneManager::X_RenderPBRBlend(
-	Blender::BlenderRenderer* renderer,
-	int threadID,
-	RenderMesh& sceneMesh,
-	std::vector<RenderMesh>& meshes,
-	std::vector<Camera>& cams,
-	std::vector<Light>& lights,
-	std::vector<Mask>& masks,
-	std::vector<SceneImage>& sceneRGBs
+	PendingBatch& batch
 ) const
 {
-	// Initialize output vector
-	std::vector<Texture> objectPBRs, objectsAO;
-	objectPBRs.reserve(cams.size());
-	objectsAO.reserve(cams.size());
-
-	// Create & process ambient occlusion renderfile
-#if USE_AO
-	RENDERFILE_SINGLE(renderer, threadID, X_BuildObjectsAO, sceneMesh, meshes, cams, lights, objectsAO);
-#else
-	objectsAO.assign(cams.size(), Texture(false, false));
-#endif
-
-	// Create & process PBR renderfile
-	RENDERFILE_SINGLE(renderer, threadID, X_BuildObjectsPBR, sceneMesh, meshes, cams, lights, objectPBRs);
+	// AO & PBR have to be rendered
+	if (batch.AOJob)
+		batch.AOJob->Wait();
+	batch.PBRJob->Wait();
+	if (batch.AlbedoJob)
+		batch.AlbedoJob->Wait();
+	if (batch.NormalJob)
+		batch.NormalJob->Wait();
 
 	// For every pose
-	for (int curr = 0; curr < cams.size(); ++curr)
+	for (int curr = 0; curr < batch.Cams.size(); ++curr)
 	{
 		// Load PBR & AO object texture
-		objectPBRs[curr].LoadTexture();
+		batch.PBRs[curr].LoadTexture();
 #if USE_AO
-		objectsAO[curr].LoadTexture(UnpackAO);
+		batch.AOs[curr].LoadTexture(UnpackAO);
 #else
-		objectsAO[curr].SetTexture(cv::Mat::ones(
-			objectPBRs[curr].GetTexture().rows,
-			objectPBRs[curr].GetTexture().cols,
+		batch.AOs[curr].SetTexture(cv::Mat::ones(
+			batch.PBRs[curr].GetTexture().rows,
+			batch.PBRs[curr].GetTexture().cols,
 			CV_32FC1
 		));
 #endif
 
+		// Already discarded while creating segments
+		if (!batch.Labels[curr].TextureExists() || !batch.Masks[curr].TextureExists())
+			continue;
+
 		// Sanity check
-		if (!objectPBRs[curr].TextureExists() || !objectsAO[curr].TextureExists())
+		if (!batch.PBRs[curr].TextureExists() || !batch.AOs[curr].TextureExists())
+		{
+			pOutputSink->Discard(batch.Cams[curr].GetImageNum());
 			continue;
+		}
+
+		// Only the crop window contains objects (empty: whole image)
+		Eigen::Vector4i crop = batch.Cams[curr].GetCropWindow();
+
+		// Rendered with few samples, denoise objects only
+		if (renderSettings.GetEngineSettings().Denoise)
+		{
+			cv::Mat albedo, normal;
+			if (curr < batch.Albedos.size() && curr < batch.Normals.size())
+			{
+				batch.Albedos[curr].LoadTexture();
+				batch.Normals[curr].LoadTexture();
+				albedo = batch.Albedos[curr].GetTexture();
+				normal = batch.Normals[curr].GetTexture();
+			}
+			batch.PBRs[curr].SetTexture(pDenoiser->Denoise(batch.PBRs[curr].GetTexture(), albedo, normal,
+				cv::Rect(crop.x(), crop.y(), crop.z(), crop.w())));
+		}
 
 		// Potentially resize original scene image
-		sceneRGBs[curr].ResizeSceneTexture(objectPBRs[curr].GetTexture());
+		batch.Images[curr].ResizeSceneTexture(batch.PBRs[curr].GetTexture());
+
+#if USE_AO
+		// Upsample low resolution AO along object edges
+		const cv::Mat& mask = batch.Masks[curr].GetTexture();
+		if (batch.AOs[curr].GetTexture().size() != mask.size())
+		{
+			const cv::Mat& labels = batch.Labels[curr].GetTexture();
+			cv::Mat upsampled;
+			if (labels.size() == mask.size())
+			{
+				upsampled = ComputeAOUpsample(batch.AOs[curr].GetTexture(), batch.Masks[curr].GetBlendedDepth().GetTexture(),
+					labels, mask, AO_FILTER_RADIUS, AO_DEPTH_SIGMA);
+			}
+			else
+			{
+				cv::resize(batch.AOs[curr].GetTexture(), upsampled, mask.size(), 0.0, 0.0, cv::INTER_LINEAR);
+			}
+			batch.AOs[curr].SetTexture(upsampled);
+		}
+#endif
 
 		// Blend & store result
 		Texture blendResult(false, false);
-		blendResult.SetPath(renderSettings.GetImagePath("rgb", cams[curr].GetImageNum(), true), false);
+		blendResult.SetPath(renderSettings.GetImagePath("rgb", batch.Cams[curr].GetImageNum(), true), false);
 		blendResult.SetTexture(ComputeRGBBlend(
-			objectPBRs[curr].GetTexture(),
-			objectsAO[curr].GetTexture(),
-			sceneRGBs[curr].GetSceneTexture(),
-			masks[curr].GetTexture())
-		);
-		blendResult.StoreTexture();
+			batch.PBRs[curr].GetTexture(),
+			batch.AOs[curr].GetTexture(),
+			batch.Images[curr].GetSceneTexture(),
+			batch.Masks[curr].GetTexture(),
+#if USE_CROP
+			cv::Rect(crop.x(), crop.y(), crop.z(), crop.w())
+#else
+			cv::Rect()
+#endif
+		));
+		blendResult.StoreTexture(*pOutputSink, batch.Cams[curr].GetImageNum());
+
+		// Sample is complete
+		pOutputSink->Commit(batch.Cams[curr].GetImageNum());
+	}
+}
+
+//---------------------------------------
+// Post-process a submitted batch
+//---------------------------------------
+void SceneManager::X_FinishBatch(
+	Blender::BlenderRenderer* renderer,
+	int threadID,
+	AnnotationsManager* annotations,
+	std::vector<RenderMesh>& meshes,
+	PendingBatch& batch
+) const
+{
+	// Create segments & annotations
+	renderer->LogPerformance("Labels & Annotating", threadID);
+	X_RenderSegments(annotations, meshes, batch);
+	renderer->LogPerformance("Labels & Annotating", threadID);
+
+	// Blend synthetic image with real one
+	renderer->LogPerformance("PBR Render & Blend", threadID);
+	X_RenderPBRBlend(batch);
+	renderer->LogPerformance("PBR Render & Blend", threadID);
+}
+
+//---------------------------------------
+// Convert textures in parallel ahead of rendering
+//---------------------------------------
+void SceneManager::X_PrewarmTextures(
+	const std::vector<Texture>& textures
+) const
+{
+	// Spread textures over all render processes
+	int workerCount = pRenderer->GetWorkerCount();
+	for (int worker = 0; worker < workerCount && worker < static_cast<int>(textures.size()); ++worker)
+	{
+		std::unique_ptr<RenderfileWriter> writer(CreateRenderfileWriter(renderSettings.GetEngineSettings().RenderfileFormat));
+		writer->StartObject();
+
+		writer->Key("settings");
+		renderSettings.AddToJSON(*writer);
+
+		writer->Key("textures");
+		writer->StartArray();
+		size_t count = 0;
+		for (size_t curr = worker; curr < textures.size(); curr += workerCount, ++count)
+		{
+			textures[curr].AddToJSON(*writer);
+		}
+		writer->EndArray();
+
+		writer->EndObject();
+
+		// Not waited for, renders of the process queue up behind it
+		pRenderer->PrewarmTextures(writer->GetRenderfile(), count * RENDER_TIMEOUT, worker);
 	}
 }
 
@@ -1049,11 +1481,14 @@ std::vector<SceneImage> SceneManager::X_GetImagesToProcess(
 // Processing is done multithreaded
 //---------------------------------------
 void SceneManager::X_ProcessThread(
-	Blender::BlenderRenderer* renderer,
+	RenderPool* pool,
 	boost::mutex* syncPoint,
 	int threadID
 )
 {
+	// Used for performance logging
+	Blender::BlenderRenderer* renderer = pool->GetRenderer();
+
 	// Only the first thread computes non-blurry images and generates lighting information
 	syncPoint->lock();
 	X_ComputeImagesToProcess(renderSettings.GetSceneRGBPath());
@@ -1072,13 +1507,28 @@ void SceneManager::X_ProcessThread(
 
 	// Control params
 	int maxIters = renderSettings.GetSimulationSettings().SceneIterations;
+	int layoutCount = renderSettings.GetSimulationSettings().SimulationLayouts;
 	size_t poseCount = sceneImages.size();
 	size_t batchSize = renderSettings.GetSimulationSettings().BatchSize;
 	size_t batchMax = ceil(static_cast<float>(poseCount) / static_cast<float>(batchSize));
 	ModifiablePath scenePath = boost::filesystem::relative(renderSettings.GetSceneRGBPath());
 
+	// Simulated but not yet rendered object layouts
+	std::deque<std::vector<SimulatedObject>> pendingLayouts;
+
+	// Layouts are stored per scene iteration (thread & iteration of this thread)
+	std::string simCache(renderSettings.GetSimulationSettings().SimulationCache);
+	bool replaySims = simCache == "replay";
+	bool recordSims = replaySims || simCache == "record";
+
+	// Meshes of scan scene, kept for all iterations
+	syncPoint->lock();
+	auto pxMeshScene = X_PxCreateSceneMesh();
+	auto meshScene = X_CreateSceneMesh();
+	syncPoint->unlock();
+
 	// For each scene iteration
-	for (int iter = 0; iter < maxIters && imgCountScene < renderSettings.GetSimulationSettings().SceneLimit; ++iter)
+	for (int iter = 0; iter < maxIters && imgCountScene < renderSettings.GetSimulationSettings().SceneLimit && pOutputSink->IsOpen(); ++iter)
 	{
 		renderer->LogPerformance("Iteration " + std::to_string(iter + 1), threadID);
 
@@ -1086,18 +1536,10 @@ void SceneManager::X_ProcessThread(
 		ModifiablePath annotationPath = renderSettings.GetFinalPath() / "annotations";
 		Eigen::Vector2i renderRes = camBlueprint.GetIntrinsics().GetResolution();
 		renderRes *= renderSettings.GetEngineSettings().RenderScale;
-		auto annotations = new AnnotationsManager(annotationPath, renderRes);
+		auto annotations = new AnnotationsManager(annotationPath, renderRes, *pOutputSink);
 
-		syncPoint->lock();
-		// Create render mesh of scan scene
-		auto meshScene = X_CreateSceneMesh();
-		// Create physx mesh of scan scene
-		auto pxMeshScene = X_PxCreateSceneMesh();
-		syncPoint->unlock();
-
-		// Create simulation
-		float maxDist = 0.0f;
-		auto simulation = X_PxCreateSimulation(pxMeshScene, maxDist);
+		// Maximal possible distance (for human readable depth)
+		float maxDist = pxMeshScene.GetGlobalBounds().getDimensions().magnitude();
 
 		// Load scene exposures
 		rapidjson::Document exposures;
@@ -1117,21 +1559,64 @@ void SceneManager::X_ProcessThread(
 			)
 		);
 
-		// Init random generator
-		std::random_device randDev;
-		auto randGen = std::default_random_engine(randDev());
+		// Stored layouts replace simulating, if still valid
+		int cacheIter = threadID * maxIters + iter;
+		if (pendingLayouts.empty() && replaySims)
+		{
+			std::vector<SimulatedObject> storedObjs;
+			if (X_LoadSimResults(cacheIter, storedObjs))
+			{
+				pendingLayouts.push_back(std::move(storedObjs));
+			}
+		}
 
-		// Create physx objects
-		auto vecPxObjs = X_PxCreateObjs(randGen, pxMeshScene, simulation);
+		// Simulate several layouts at once, each is used for one iteration
+		if (pendingLayouts.empty())
+		{
+			// Init random generator, seed is stored with the layouts
+			std::random_device randDev;
+			unsigned int seed = randDev();
+			auto randGen = std::default_random_engine(seed);
+
+			// Create simulation
+			auto simulation = X_PxCreateSimulation(pxMeshScene, maxDist);
+
+			// Create physx objects, every layout in its own collision group
+			int layouts = std::min(layoutCount, maxIters - iter);
+			std::vector<std::vector<PxMeshConvex>> layoutPxObjs;
+			for (int layout = 0; layout < layouts; ++layout)
+			{
+				layoutPxObjs.push_back(X_PxCreateObjs(randGen, pxMeshScene, simulation, static_cast<PxU32>(layout + 1)));
+			}
+
+			// Run the simulation
+			int simSteps = X_PxRunSim(simulation, 1.0f / 50.0f, renderSettings.GetSimulationSettings().SimulationSteps);
+			{
+				std::lock_guard<std::mutex> lock(simStepLock);
+				simStepCounts.push_back(simSteps);
+			}
+
+			// Save results, physx isn't needed for rendering
+			for (int layout = 0; layout < layouts; ++layout)
+			{
+				pendingLayouts.push_back(X_PxSaveSimResults(layoutPxObjs[layout]));
+				if (recordSims)
+				{
+					X_StoreSimResults(cacheIter + layout, seed, layout, pendingLayouts.back());
+				}
+			}
+			X_CleanupScene(simulation, NULL);
+		}
 
-		// Run the simulation
-		X_PxRunSim(simulation, 1.0f / 50.0f, renderSettings.GetSimulationSettings().SimulationSteps);
+		// Objects of this iteration
+		auto vecObjs = X_ConvertSimResults(pendingLayouts.front());
+		pendingLayouts.pop_front();
 
-		// Save results
-		auto vecObjs = X_PxSaveSimResults(vecPxObjs);
+		// Renders of a batch overlap with processing of the previous one
+		std::unique_ptr<PendingBatch> pending;
 
 		// For every batch
-		for (size_t batch = 0; batch < batchMax && imgCountScene < renderSettings.GetSimulationSettings().SceneLimit; ++batch)
+		for (size_t batch = 0; batch < batchMax && imgCountScene < renderSettings.GetSimulationSettings().SceneLimit && pOutputSink->IsOpen(); ++batch)
 		{
 			renderer->LogPerformance("Batch " + std::to_string(batch + 1), threadID);
 			std::cout << "Scene\t" << scenePath << ":\tIteration\t" << iter + 1 << "/" << maxIters
@@ -1167,7 +1652,7 @@ void SceneManager::X_ProcessThread(
 			// Render depths & masks
 			renderer->LogPerformance("Depth & Masks", threadID);
 			std::vector<Mask> masks = X_RenderDepthMasks(
-				renderer,
+				pool,
 				threadID,
 				meshScene,
 				vecObjs,
@@ -1189,14 +1674,16 @@ void SceneManager::X_ProcessThread(
 				{
 					// Store & update image number atomically
 					syncPoint->lock();
-					currCams[check].SetImageNum(++imgCountUnoccluded);
+					int imageNum = ++imgCountUnoccluded;
 					syncPoint->unlock();
+					currCams[check].SetImageNum(imageNum);
 					// Store the blended depth
-					ModifiablePath depthPath = renderSettings.GetImagePath("depth", imgCountUnoccluded, true);
+					ModifiablePath depthPath = renderSettings.GetImagePath("depth", imageNum, true);
 #if STORE_DEBUG_TEX
-					masks[check].StoreBlendedDepth01(depthPath, FLT_EPSILON, maxDist);
+					masks[check].StoreBlendedDepth01(depthPath, *pOutputSink, imageNum, FLT_EPSILON, maxDist);
 #else
-					masks[check].StoreBlendedDepth(depthPath);
+					masks[check].GetBlendedDepth().SetPath(depthPath, false);
+					masks[check].GetBlendedDepth().StoreTexture(*pOutputSink, imageNum);
 #endif
 					// Move corresponding poses, masks & real images
 					unoccludedCams.push_back(std::move(currCams[check]));
@@ -1205,48 +1692,47 @@ void SceneManager::X_ProcessThread(
 				}
 			}
 
-			// If batch contains useful images
+			// Submit renders of the batch if it contains useful images
+			size_t unoccludedCount = unoccludedImages.size();
+			std::unique_ptr<PendingBatch> submitted;
 			if (!unoccludedImages.empty())
 			{
-				// Render labels & create annotations
-				renderer->LogPerformance("Labels & Annotating", threadID);
-				X_RenderSegments(
-					renderer,
+				submitted = X_SubmitBatch(
+					pool,
 					threadID,
-					annotations,
 					meshScene,
 					vecObjs,
-					unoccludedCams,
 					vecLights,
-					unoccludedMasks
+					std::move(unoccludedCams),
+					std::move(unoccludedMasks),
+					std::move(unoccludedImages)
 				);
-				renderer->LogPerformance("Labels & Annotating", threadID);
+			}
 
-				// Render synthetic image & blend with real one
-				renderer->LogPerformance("PBR Render & Blend", threadID);
-				X_RenderPBRBlend(
-					renderer,
-					threadID,
-					meshScene,
-					vecObjs,
-					unoccludedCams,
-					vecLights,
-					unoccludedMasks,
-					unoccludedImages
-				);
-				renderer->LogPerformance("PBR Render & Blend", threadID);
+			// Meanwhile process the previous batch
+			if (pending)
+			{
+				X_FinishBatch(renderer, threadID, annotations, vecObjs, *pending);
 			}
+			pending = std::move(submitted);
 
 			// Update scene limit & output duration
 			syncPoint->lock();
-			imgCountScene += unoccludedImages.size();
+			imgCountScene += unoccludedCount;
 			syncPoint->unlock();
 			renderer->LogPerformance("Batch " + std::to_string(batch + 1), threadID);
 		}
 
+		// Last batch is still pending
+		if (pending)
+		{
+			X_FinishBatch(renderer, threadID, annotations, vecObjs, *pending);
+			pending.reset();
+		}
+
 		// Done with iteration
 		renderer->LogPerformance("Iteration " + std::to_string(iter + 1), threadID);
-		X_CleanupScene(simulation, annotations, renderer, threadID);
+		X_CleanupScene(NULL, annotations);
 	}
 }
 
@@ -1261,22 +1747,25 @@ int SceneManager::ProcessNext(
 	imgCountUnoccluded = imageCount;
 	imgCountScene = 0;
 
-	// Create threaded renderer (Each process needs ~4GB!)
+	// Render processes are reused from previous scenes
 	auto syncPoint = new boost::mutex();
-	auto cpuCount = std::thread::hardware_concurrency() / 2U;
-	auto memCount = (SafeGet<int>(renderSettings.GetJSONConfig(), "mem_available") - 1U) / 4U;
-	auto processCount = std::min(cpuCount, memCount);
-	auto render = new Blender::BlenderRenderer(processCount);
 
-	// Create one thread / core
+	// Convert scene texture while the threads simulate
+	std::vector<Texture> sceneTextures(1);
+	sceneTextures[0].SetPath(renderSettings.GetScenePath() / "mesh.refined_0.png", false);
+	X_PrewarmTextures(sceneTextures);
+
+	// Scene threads share all render processes
+	int producerCount = renderSettings.GetEngineSettings().ProducerThreads;
+	producerCount = producerCount > 0 ? producerCount : processCount;
 	std::vector<boost::thread*> threads;
-	for (int i = 0; i < processCount; ++i)
+	for (int i = 0; i < producerCount; ++i)
 	{
-		threads.push_back(new boost::thread(&SceneManager::X_ProcessThread, this, render, syncPoint, i));
+		threads.push_back(new boost::thread(&SceneManager::X_ProcessThread, this, pRenderPool, syncPoint, i));
 	}
 
 	// Wait until done
-	for (int i = 0; i < processCount; ++i)
+	for (int i = 0; i < producerCount; ++i)
 	{
 		threads[i]->join();
 		delete threads[i];
@@ -1284,7 +1773,37 @@ int SceneManager::ProcessNext(
 
 	// Cleanup
 	PTR_RELEASE(syncPoint);
-	PTR_RELEASE(render);
+
+	// Clear scenes of render processes (keeps them running)
+	pRenderPool->ResetAll();
+
+	// Report avoided process restarts
+	std::cout << "Reused render processes, saved " << pRenderer->PopStartupSaved() << "s of startup" << std::endl;
+	std::cout << "Lost " << pRenderPool->PopWasted() << "s to failed renders" << std::endl;
+	pRenderPool->PrintRenderfileBytes();
+
+	// Report how long simulations took to settle (ten buckets up to the limit)
+	int stepLimit = std::max(renderSettings.GetSimulationSettings().SimulationSteps, 1);
+	int bucketSize = std::max((stepLimit + 9) / 10, 1);
+	std::vector<int> stepHistogram((stepLimit + bucketSize - 1) / bucketSize + 1, 0);
+	for (int steps : simStepCounts)
+	{
+		stepHistogram[std::min(steps / bucketSize, static_cast<int>(stepHistogram.size()) - 1)]++;
+	}
+	// Mean & spawn mode allow comparing runs with different placement
+	float meanSteps = simStepCounts.empty() ? 0.0f :
+		static_cast<float>(std::accumulate(simStepCounts.begin(), simStepCounts.end(), 0)) / simStepCounts.size();
+	std::cout << "Simulation steps until settled (" << simStepCounts.size() << " iterations, mean " << meanSteps
+		<< ", " << renderSettings.GetSpawnSettings().SpawnMode << " spawning):" << std::endl;
+	for (size_t bucket = 0; bucket < stepHistogram.size(); ++bucket)
+	{
+		if (stepHistogram[bucket] > 0)
+		{
+			std::cout << "\t" << bucket * bucketSize << "-" << std::min(static_cast<int>((bucket + 1) * bucketSize) - 1, stepLimit)
+				<< ":\t" << stepHistogram[bucket] << std::endl;
+		}
+	}
+	simStepCounts.clear();
 
 	// Return how many images were rendered
 	return (imgCountUnoccluded - imageCount);
@@ -1299,11 +1818,77 @@ SceneManager::SceneManager(
 	const std::vector<RenderMesh*>& vecRenderMeshObjs
 ) :
 	camBlueprint(),
+	pRenderer(NULL),
+	pRenderPool(NULL),
+	pDenoiser(NULL),
+	processCount(0),
 	vecpPxMeshObjs(vecPxMeshObjs),
 	vecpRenderMeshObjs(vecRenderMeshObjs),
 	renderSettings(settings),
+	pOutputSink(NULL),
 	imgCountDepth(0),
 	imgCountUnoccluded(0),
-	imgCountScene(0)
+	imgCountScene(0),
+	simStepCounts(),
+	simStepLock()
+{
+	// Create final output sink
+	Settings::Output output = renderSettings.GetOutputSettings();
+	if (output.Format == "shards")
+	{
+		pOutputSink = new ShardSink(renderSettings.GetFinalPath(), output.ShardSize);
+	}
+	else if (output.Format == "stream")
+	{
+		pOutputSink = new StreamSink(output.StreamPath, output.StreamQueue);
+	}
+	else
+	{
+		pOutputSink = new FileSink();
+	}
+
+	// Create threaded renderer for the whole run (Each process needs ~4GB!)
+	auto cpuCount = std::thread::hardware_concurrency() / 2U;
+	auto memCount = (SafeGet<int>(renderSettings.GetJSONConfig(), "mem_available") - 1U) / 4U;
+	processCount = std::min(cpuCount, memCount);
+	pRenderer = new Blender::BlenderRenderer(processCount, renderSettings.GetEngineSettings().WorkerMemLimit);
+	pRenderPool = new RenderPool(
+		pRenderer,
+		renderSettings.GetEngineSettings().RenderfileFormat,
+		renderSettings.GetEngineSettings().DeltaRenderfiles
+	);
+
+	// Denoiser threads are not taken from the render processes
+	if (renderSettings.GetEngineSettings().Denoise)
+	{
+		pDenoiser = new Denoiser(renderSettings.GetEngineSettings().DenoiseThreads);
+	}
+
+	// Convert object textures while the first scene loads
+	std::vector<Texture> objectTextures;
+	for (auto currMesh : vecpRenderMeshObjs)
+	{
+		// Metal & glass shaders use no textures
+		if (currMesh->GetShaderType() == "metal" || currMesh->GetShaderType() == "glass")
+			continue;
+		Texture currDiffuse;
+		currDiffuse.SetPath(currMesh->GetTexturePath(), false);
+		if (currDiffuse.TextureExists())
+		{
+			objectTextures.push_back(std::move(currDiffuse));
+		}
+	}
+	X_PrewarmTextures(objectTextures);
+}
+
+//---------------------------------------
+// Cleanup scene manager
+//---------------------------------------
+SceneManager::~SceneManager()
 {
+	// Finishes pending output
+	PTR_RELEASE(pOutputSink);
+	PTR_RELEASE(pRenderPool);
+	PTR_RELEASE(pRenderer);
+	PTR_RELEASE(pDenoiser);
 }
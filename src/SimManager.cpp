@@ -19,7 +19,12 @@ void SimManager::X_CreateOutputFolders()
 	{
 		create_directories(finalDir);
 	}
-	if (is_empty(finalDir))
+	if (is_empty(finalDir) && pRenderSettings->GetOutputSettings().Format != "files")
+	{
+		// Shards directory is created by the sink, streams need none
+		create_directories(finalDir / "models");
+	}
+	else if (is_empty(finalDir))
 	{
 		create_directories(finalDir / "rgb");
 		create_directories(finalDir / "depth");
@@ -42,6 +47,12 @@ void SimManager::X_CreateOutputFolders()
 		create_directories(tempDir / "body_ao");
 	}
 
+	// Create persistent cache directories
+	ModifiablePath cacheDir(pRenderSettings->GetCachePath());
+	create_directories(cacheDir / "shaders");
+	create_directories(cacheDir / "simulations");
+	create_directories(cacheDir / "meshes");
+	MeshCache::SetCacheDirectory(cacheDir / "meshes");
 }
 
 //---------------------------------------
@@ -55,18 +66,31 @@ void SimManager::X_LoadMeshes()
 	VEC_RELEASE(vecpRenderMesh);
 	VEC_RELEASE(vecpPxMesh);
 
+	auto loadStart = std::chrono::steady_clock::now();
+
+	// Everything needed to create the meshes of one object
+	struct MeshDescriptor
+	{
+		ModifiablePath MeshPath;
+		ModifiablePath TexturePath;
+		std::string MeshClass;
+		std::string MeshShader;
+		float MeshUnit;
+		int MeshId;
+	};
+	std::vector<MeshDescriptor> descriptors;
+
 	// Load values from json & initialize
 
 	rapidjson::Value objects = SafeGetArray(pRenderSettings->GetJSONConfig(), "render_objs");
-	vecpPxMesh.reserve(objects.Size());
-	vecpRenderMesh.reserve(objects.Size());
+	descriptors.reserve(objects.Size());
 
 	// If path exists & directory
 	if (exists(pRenderSettings->GetMeshesPath()))
 	{
 		if (is_directory(pRenderSettings->GetMeshesPath()))
 		{
-			// For each object
+			// For each object (id is the index in the config, independent of load order)
 			for (int i = 0; i < static_cast<int>(objects.Size()); ++i)
 			{
 				// Get mesh descriptor
@@ -101,35 +125,89 @@ void SimManager::X_LoadMeshes()
 					meshShader = std::string(SafeGetValue<const char*>(*shaderVal));
 				}
 
-				// Create and save physx mesh
-				PxMeshConvex* pxCurr = new PxMeshConvex(meshPath, meshClass, i);
-				pxCurr->SetObjId(0);
-				pxCurr->CreateMesh();
-				pxCurr->SetScale(physx::PxVec3(objScl));
-				vecpPxMesh.push_back(pxCurr);
-
-				// Create and save render mesh
-				RenderMesh* renderCurr = new RenderMesh(meshPath, texturePath, meshClass, meshShader, i);
-				renderCurr->SetObjId(0);
-				renderCurr->CreateMesh();
-				renderCurr->SetScale(Eigen::Vector3f().setConstant(objScl));
-				vecpRenderMesh.push_back(renderCurr);
-
-				// Copy the mesh to final folder
-				boost::system::error_code res;
-				copy_file(
-					meshPath,
-					pRenderSettings->GetFinalPath() / "models" / meshPath.filename(),
-					copy_option::fail_if_exists,
-					res
-				);
-
-				std::cout << std::endl;
+				descriptors.push_back(MeshDescriptor{ meshPath, texturePath, meshClass, meshShader, objScl, i });
 			}
 		}
 	}
 	// Cleanup
 	SafeDeleteArray(objects);
+
+	// Every mesh is created into its own slot, so the order stays the config order
+	std::vector<PxMeshConvex*> pxMeshes(descriptors.size(), NULL);
+	std::vector<RenderMesh*> renderMeshes(descriptors.size(), NULL);
+	std::vector<float> loadSeconds(descriptors.size(), 0.0f);
+	std::atomic<size_t> nextMesh(0);
+	size_t loadedMeshes = 0;
+	std::mutex progressLock;
+
+	// Import, cooking & copying are independent for each mesh
+	auto loadWorker = [&]()
+	{
+		for (size_t curr = nextMesh++; curr < descriptors.size(); curr = nextMesh++)
+		{
+			const MeshDescriptor& desc = descriptors[curr];
+			auto meshStart = std::chrono::steady_clock::now();
+
+			// Create physx mesh
+			PxMeshConvex* pxCurr = new PxMeshConvex(desc.MeshPath, desc.MeshClass, desc.MeshId);
+			pxCurr->SetObjId(0);
+			pxCurr->CreateMesh();
+			pxCurr->SetScale(physx::PxVec3(desc.MeshUnit));
+			pxMeshes[curr] = pxCurr;
+
+			// Create render mesh
+			RenderMesh* renderCurr = new RenderMesh(desc.MeshPath, desc.TexturePath, desc.MeshClass, desc.MeshShader, desc.MeshId);
+			renderCurr->SetObjId(0);
+			renderCurr->CreateMesh();
+			renderCurr->SetScale(Eigen::Vector3f().setConstant(desc.MeshUnit));
+			renderMeshes[curr] = renderCurr;
+
+			// Copy the mesh to final folder
+			boost::system::error_code res;
+			copy_file(
+				desc.MeshPath,
+				pRenderSettings->GetFinalPath() / "models" / desc.MeshPath.filename(),
+				copy_option::fail_if_exists,
+				res
+			);
+
+			loadSeconds[curr] = std::chrono::duration<float>(std::chrono::steady_clock::now() - meshStart).count();
+			std::lock_guard<std::mutex> lock(progressLock);
+			std::cout << "\33[2K\r" << "Loading meshes:\t" << ++loadedMeshes << "/" << descriptors.size() << std::flush;
+		}
+	};
+
+	// 0: One thread per core
+	size_t loadThreads = pRenderSettings->GetSimulationSettings().LoadThreads > 0 ?
+		pRenderSettings->GetSimulationSettings().LoadThreads : std::max(std::thread::hardware_concurrency(), 1u);
+	loadThreads = std::max(std::min(loadThreads, descriptors.size()), static_cast<size_t>(1));
+	std::vector<std::thread> loaders;
+	for (size_t i = 1; i < loadThreads; ++i)
+	{
+		loaders.emplace_back(loadWorker);
+	}
+	loadWorker();
+	for (auto& loader : loaders)
+	{
+		loader.join();
+	}
+
+	// Save meshes
+	vecpPxMesh.reserve(descriptors.size());
+	vecpRenderMesh.reserve(descriptors.size());
+	vecpPxMesh.insert(vecpPxMesh.end(), pxMeshes.begin(), pxMeshes.end());
+	vecpRenderMesh.insert(vecpRenderMesh.end(), renderMeshes.begin(), renderMeshes.end());
+
+	// Startup timing report
+	float totalSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - loadStart).count();
+	float workSeconds = std::accumulate(loadSeconds.begin(), loadSeconds.end(), 0.0f);
+	std::cout << "\33[2K\r" << "Loaded " << descriptors.size() << " meshes in " << totalSeconds << "s with "
+		<< loadThreads << " threads (" << workSeconds << "s of work)" << std::endl;
+	if (!loadSeconds.empty())
+	{
+		size_t slowest = std::max_element(loadSeconds.begin(), loadSeconds.end()) - loadSeconds.begin();
+		std::cout << "Slowest mesh:\t" << descriptors[slowest].MeshPath.filename() << " (" << loadSeconds[slowest] << "s)" << std::endl;
+	}
 }
 
 //---------------------------------------
@@ -181,6 +259,12 @@ void SimManager::RunSimulation()
 		currImageCount += sceneMgr.ProcessNext(currImageCount);
 		if (currImageCount >= pRenderSettings->GetSimulationSettings().TotalLimit)
 			break;
+		else if (!sceneMgr.IsOutputOpen())
+		{
+			// Nothing would be stored anymore
+			std::cout << "Output closed, stopping at " << currImageCount << " images" << std::endl;
+			break;
+		}
 		else
 			std::cout << "Switching scene, progress: " << currImageCount << "/"
 			<< pRenderSettings->GetSimulationSettings().TotalLimit << " images generated" << std::endl;
@@ -197,7 +281,7 @@ SimManager::SimManager(Settings* pSettings) :
 	vecpPxMesh()
 {
 	// Init
-	PxManager::GetInstance().InitPhysx();
+	PxManager::GetInstance().InitPhysx(pRenderSettings->GetSimulationSettings().PhysxThreads);
 	X_CreateOutputFolders();
 	X_LoadMeshes();
 
@@ -0,0 +1,96 @@
+#include <cmath>
+#include <iostream>
+
+#pragma warning(push, 0)
+#include <opencv2/opencv.hpp>
+
+#include <Helpers/ImageProcessing.h>
+#pragma warning(pop)
+
+// Same filter as the renderer
+#define AO_FILTER_RADIUS 2
+#define AO_DEPTH_SIGMA 0.02f
+#define IMAGE_SIZE 128
+
+//---------------------------------------
+// Synthetic AO, depth & labels of two objects in front of the background
+//---------------------------------------
+struct SyntheticScene
+{
+	cv::Mat AO;
+	cv::Mat Depth;
+	cv::Mat Labels;
+	cv::Mat Mask;
+
+	SyntheticScene() :
+		AO(IMAGE_SIZE, IMAGE_SIZE, CV_32FC1, cv::Scalar(1.0f)),
+		Depth(IMAGE_SIZE, IMAGE_SIZE, CV_32FC1),
+		Labels(IMAGE_SIZE, IMAGE_SIZE, CV_8UC1),
+		Mask(IMAGE_SIZE, IMAGE_SIZE, CV_8UC1, cv::Scalar(0))
+	{
+		for (int y = 0; y < IMAGE_SIZE; ++y)
+		{
+			for (int x = 0; x < IMAGE_SIZE; ++x)
+			{
+				// Object edge doesn't line up with the low resolution pixels
+				bool isLeft = x < 66;
+				Depth.at<float>(y, x) = isLeft ? 2.0f + 0.002f * y : 1.0f;
+				Labels.at<uchar>(y, x) = isLeft ? 10 : 20;
+				if (y < 9 || x < 9 || y >= IMAGE_SIZE - 9 || x >= IMAGE_SIZE - 9)
+					continue;
+				Mask.at<uchar>(y, x) = 255;
+				AO.at<float>(y, x) = isLeft ? 0.8f - 0.2f * y / IMAGE_SIZE : 0.3f + 0.1f * std::sin(x / 10.0f);
+			}
+		}
+	}
+};
+
+//---------------------------------------
+// Error on the object pixels
+//---------------------------------------
+static double MaskedRMSE(
+	const cv::Mat& result,
+	const cv::Mat& expected,
+	const cv::Mat& mask
+)
+{
+	cv::Mat diff;
+	cv::subtract(result, expected, diff, cv::noArray(), CV_64F);
+	diff = diff.mul(diff);
+	return std::sqrt(cv::mean(diff, mask)[0]);
+}
+
+//---------------------------------------
+// Upsampled AO has to stay close to the full resolution AO
+//---------------------------------------
+static bool CheckScale(
+	const SyntheticScene& scene,
+	float scale,
+	double maxRMSE
+)
+{
+	// Low resolution render averages the covered pixels
+	cv::Mat lowAO, linear;
+	cv::resize(scene.AO, lowAO, cv::Size(), scale, scale, cv::INTER_AREA);
+	cv::resize(lowAO, linear, scene.Mask.size(), 0.0, 0.0, cv::INTER_LINEAR);
+	cv::Mat upsampled = ComputeAOUpsample(lowAO, scene.Depth, scene.Labels, scene.Mask, AO_FILTER_RADIUS, AO_DEPTH_SIGMA);
+
+	double linearRMSE = MaskedRMSE(linear, scene.AO, scene.Mask);
+	double upsampledRMSE = MaskedRMSE(upsampled, scene.AO, scene.Mask);
+	bool passed = upsampledRMSE <= maxRMSE && upsampledRMSE < linearRMSE;
+	std::cout << "ao_scale " << scale << ": RMSE " << upsampledRMSE << " (bilinear " << linearRMSE << ", limit " << maxRMSE << ") "
+		<< (passed ? "passed" : "FAILED") << std::endl;
+	return passed;
+}
+
+//---------------------------------------
+// Entry point
+//---------------------------------------
+int main()
+{
+	SyntheticScene scene;
+	// Limits are ~1.4x the error of the current filter
+	bool passed = CheckScale(scene, 0.5f, 0.025);
+	passed &= CheckScale(scene, 0.25f, 0.05);
+	return passed ? 0 : 1;
+}
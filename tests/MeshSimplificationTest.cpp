@@ -0,0 +1,173 @@
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#pragma warning(push, 0)
+#include <Eigen/Dense>
+
+#include <Helpers/MeshSimplification.h>
+#pragma warning(pop)
+
+// Quadrics only estimate the distance (to the planes of the collapsed triangles), so some slack is allowed
+#define ERROR_TOLERANCE 2.0f
+
+//---------------------------------------
+// Indexed triangle mesh as used by the physx meshes
+//---------------------------------------
+struct TestMesh
+{
+	std::vector<float> Vertices;
+	std::vector<int> Indices;
+
+	inline Eigen::Vector3f Vertex(int index) const
+	{
+		return Eigen::Vector3f(Vertices[index * 3], Vertices[index * 3 + 1], Vertices[index * 3 + 2]);
+	}
+};
+
+//---------------------------------------
+// Closed unit sphere, vertices shared across the seam & poles
+//---------------------------------------
+static TestMesh CreateSphere(
+	int rings,
+	int segments
+)
+{
+	TestMesh sphere;
+	const float pi = 3.14159265f;
+	// Poles first, then one ring of vertices per latitude
+	sphere.Vertices = { 0.0f, 1.0f, 0.0f, 0.0f, -1.0f, 0.0f };
+	for (int ring = 1; ring < rings; ++ring)
+	{
+		float theta = pi * ring / rings;
+		for (int segment = 0; segment < segments; ++segment)
+		{
+			float phi = 2.0f * pi * segment / segments;
+			sphere.Vertices.insert(sphere.Vertices.end(),
+				{ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+		}
+	}
+	auto ringVertex = [&](int ring, int segment) { return 2 + (ring - 1) * segments + segment % segments; };
+	for (int segment = 0; segment < segments; ++segment)
+	{
+		sphere.Indices.insert(sphere.Indices.end(), { 0, ringVertex(1, segment + 1), ringVertex(1, segment) });
+		sphere.Indices.insert(sphere.Indices.end(), { 1, ringVertex(rings - 1, segment), ringVertex(rings - 1, segment + 1) });
+		for (int ring = 1; ring < rings - 1; ++ring)
+		{
+			sphere.Indices.insert(sphere.Indices.end(),
+				{ ringVertex(ring, segment), ringVertex(ring, segment + 1), ringVertex(ring + 1, segment) });
+			sphere.Indices.insert(sphere.Indices.end(),
+				{ ringVertex(ring, segment + 1), ringVertex(ring + 1, segment + 1), ringVertex(ring + 1, segment) });
+		}
+	}
+	return sphere;
+}
+
+//---------------------------------------
+// Closest point on a triangle (Ericson, Real-Time Collision Detection 5.1.5)
+//---------------------------------------
+static float PointTriangleDistance(
+	const Eigen::Vector3f& p,
+	const Eigen::Vector3f& a,
+	const Eigen::Vector3f& b,
+	const Eigen::Vector3f& c
+)
+{
+	Eigen::Vector3f ab = b - a, ac = c - a, ap = p - a;
+	float d1 = ab.dot(ap), d2 = ac.dot(ap);
+	if (d1 <= 0.0f && d2 <= 0.0f)
+		return (p - a).norm();
+
+	Eigen::Vector3f bp = p - b;
+	float d3 = ab.dot(bp), d4 = ac.dot(bp);
+	if (d3 >= 0.0f && d4 <= d3)
+		return (p - b).norm();
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		return (p - (a + ab * (d1 / (d1 - d3)))).norm();
+
+	Eigen::Vector3f cp = p - c;
+	float d5 = ab.dot(cp), d6 = ac.dot(cp);
+	if (d6 >= 0.0f && d5 <= d6)
+		return (p - c).norm();
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		return (p - (a + ac * (d2 / (d2 - d6)))).norm();
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		return (p - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))))).norm();
+
+	float denom = 1.0f / (va + vb + vc);
+	return (p - (a + ab * (vb * denom) + ac * (vc * denom))).norm();
+}
+
+//---------------------------------------
+// Largest distance of an original vertex to the simplified surface
+//---------------------------------------
+static float MaxDeviation(
+	const TestMesh& original,
+	const TestMesh& simplified
+)
+{
+	float maxDist = 0.0f;
+	for (size_t vertex = 0; vertex < original.Vertices.size() / 3; ++vertex)
+	{
+		Eigen::Vector3f p = original.Vertex(static_cast<int>(vertex));
+		float minDist = std::numeric_limits<float>::max();
+		for (size_t tri = 0; tri + 2 < simplified.Indices.size(); tri += 3)
+		{
+			minDist = std::min(minDist, PointTriangleDistance(p, simplified.Vertex(simplified.Indices[tri]),
+				simplified.Vertex(simplified.Indices[tri + 1]), simplified.Vertex(simplified.Indices[tri + 2])));
+		}
+		maxDist = std::max(maxDist, minDist);
+	}
+	return maxDist;
+}
+
+//---------------------------------------
+// Simplified mesh has to be smaller & stay within the error bound
+//---------------------------------------
+static bool CheckError(
+	const TestMesh& original,
+	float maxError
+)
+{
+	TestMesh simplified(original);
+	if (!ComputeSimplifiedMesh(simplified.Vertices, simplified.Indices, maxError))
+	{
+		std::cout << "collision_error " << maxError << ": not simplified FAILED" << std::endl;
+		return false;
+	}
+
+	float deviation = MaxDeviation(original, simplified);
+	bool passed = simplified.Indices.size() < original.Indices.size() && simplified.Indices.size() % 3 == 0 &&
+		deviation <= maxError * ERROR_TOLERANCE;
+	std::cout << "collision_error " << maxError << ": " << original.Indices.size() / 3 << " -> " << simplified.Indices.size() / 3
+		<< " triangles, deviation " << deviation << " (limit " << maxError * ERROR_TOLERANCE << ") " << (passed ? "passed" : "FAILED") << std::endl;
+	return passed;
+}
+
+//---------------------------------------
+// Entry point
+//---------------------------------------
+int main()
+{
+	TestMesh sphere = CreateSphere(48, 96);
+
+	// Disabled simplification leaves the mesh alone
+	TestMesh unchanged(sphere);
+	bool passed = !ComputeSimplifiedMesh(unchanged.Vertices, unchanged.Indices, 0.0f) &&
+		unchanged.Vertices == sphere.Vertices && unchanged.Indices == sphere.Indices;
+	std::cout << "collision_error 0: " << (passed ? "passed" : "FAILED") << std::endl;
+
+	// Unit sphere, so the errors are in radii
+	passed &= CheckError(sphere, 0.002f);
+	passed &= CheckError(sphere, 0.01f);
+	passed &= CheckError(sphere, 0.05f);
+	return passed ? 0 : 1;
+}
@@ -2,6 +2,8 @@ import os
 import re
 
 requiredFolders = set(["annotations", "depth", "rgb", "segs"])
+shardFolder = "shards"
+shardIndex = "index.csv"
 
 startNum = 1
 startMap = {}
@@ -110,8 +112,61 @@ def EnumerateSet(dir):
     startNum = 1
     startMap = {}
 
+# Reads the index of a sharded dataset
+def ReadShardIndex(dir):
+    with open(os.path.join(dir, shardIndex), "r") as index:
+        # Skip header
+        lines = index.read().splitlines()[1:]
+        # Sample; Member; Shard; Offset; Size
+        return [line.split(";") for line in lines if line]
+
+# Merge two sharded datasets (only the index is rewritten)
+def MergeShardSets(dir, merge):
+    # Merged set needs to be sharded
+    if not os.path.exists(os.path.join(merge, shardIndex)):
+        print(f"Merge: Directory {merge} is not a sharded dataset!")
+        return
+
+    # Start a new sharded set if necessary
+    if not os.path.exists(os.path.join(dir, shardIndex)):
+        os.makedirs(os.path.join(dir, shardFolder), exist_ok=True)
+        with open(os.path.join(dir, shardIndex), "w") as index:
+            index.write("Sample;Member;Shard;Offset;Size\n")
+
+    orgIndex = ReadShardIndex(dir)
+    mergeIndex = ReadShardIndex(merge)
+
+    # Samples & shards of the merged set are appended
+    lastSample = max([int(entry[0]) for entry in orgIndex], default=0)
+    lastShard = max([int(re.findall(r"\d+", entry.name)[0]) for entry in os.scandir(os.path.join(dir, shardFolder))], default=-1)
+
+    # Enumerate samples & shards without gaps
+    sampleMap = {}
+    shardMap = {}
+    for sample, member, shard, offset, size in mergeIndex:
+        if not sample in sampleMap:
+            sampleMap[sample] = lastSample + len(sampleMap) + 1
+        if not shard in shardMap:
+            shardMap[shard] = "shard_{0:06d}.tar".format(lastShard + len(shardMap) + 1)
+
+    # Move shards, contents stay untouched
+    [os.rename(os.path.join(merge, shardFolder, shard), os.path.join(dir, shardFolder, newShard)) for shard, newShard in shardMap.items()]
+
+    # Append renumbered index
+    with open(os.path.join(dir, shardIndex), "a") as index:
+        for sample, member, shard, offset, size in mergeIndex:
+            index.write(f"{sampleMap[sample]};{member};{shardMap[shard]};{offset};{size}\n")
+
+    # Merged set is empty now
+    os.remove(os.path.join(merge, shardIndex))
+
 # Merge two datasets into one
 def MergeSets(dir, merge):
+    # Sharded sets are merged via their index
+    if os.path.exists(os.path.join(merge, shardIndex)):
+        MergeShardSets(dir, merge)
+        return
+
     # Open directory
     with os.scandir(os.path.normpath(dir)) as org:
 
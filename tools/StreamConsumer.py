@@ -0,0 +1,77 @@
+import argparse
+import socket
+import struct
+import time
+import os
+
+# Reads exactly size bytes, None if the stream ended
+def ReadExact(conn, size):
+    data = bytearray()
+    while len(data) < size:
+        chunk = conn.recv(min(size - len(data), 1 << 20))
+        if not chunk:
+            return None
+        data.extend(chunk)
+    return bytes(data)
+
+# Reads one sample (number, {member: data})
+def ReadSample(conn):
+    header = ReadExact(conn, 8)
+    if header is None:
+        return None
+    sample, count = struct.unpack("<iI", header)
+    members = {}
+    for _ in range(count):
+        nameLen = struct.unpack("<I", ReadExact(conn, 4))[0]
+        name = ReadExact(conn, nameLen).decode("utf-8")
+        dataLen = struct.unpack("<Q", ReadExact(conn, 8))[0]
+        members[name] = ReadExact(conn, dataLen)
+    return sample, members
+
+def RunConsumer(path, out, delay):
+    # Remove stale socket
+    if os.path.exists(path):
+        os.remove(path)
+
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as server:
+        server.bind(path)
+        server.listen(1)
+        print(f"Waiting for generator on {path}")
+        conn, _ = server.accept()
+
+        with conn:
+            received = 0
+            receivedBytes = 0
+            start = time.time()
+            while True:
+                result = ReadSample(conn)
+                if result is None:
+                    break
+                sample, members = result
+                received += 1
+                receivedBytes += sum([len(data) for data in members.values()])
+                print(f"Sample {sample}: {', '.join(members.keys())}")
+
+                # Optionally store like the file output
+                if out:
+                    for name, data in members.items():
+                        os.makedirs(os.path.join(out, os.path.dirname(name)), exist_ok=True)
+                        with open(os.path.join(out, name), "wb") as file:
+                            file.write(data)
+
+                # Simulate training step (causes back-pressure)
+                if delay > 0:
+                    time.sleep(delay)
+
+            elapsed = max(time.time() - start, 1e-6)
+            print(f"Received {received} samples ({receivedBytes / (1 << 20):.1f} MB) in {elapsed:.1f}s, {received / elapsed:.2f} samples/s")
+
+    os.remove(path)
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Stand-in consumer for the streaming output")
+    parser.add_argument("path", help="Unix domain socket path (stream_path in the config)")
+    parser.add_argument("-o", "--out", default="", help="Directory to store received samples in")
+    parser.add_argument("-d", "--delay", type=float, default=0.0, help="Seconds to wait after each sample")
+    args = parser.parse_args()
+    RunConsumer(args.path, args.out, args.delay)